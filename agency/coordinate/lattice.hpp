@@ -100,8 +100,11 @@ class lattice
     //>;
     using index_type = decltype(value_type{} - value_type{});
 
-    // XXX should create a grid empty of points
-    lattice() = default;
+    // creates an empty lattice
+    __AGENCY_ANNOTATION
+    constexpr lattice()
+      : min_{}, max_{}
+    {}
 
     // copy from
     lattice(const lattice&) = default;
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// hints to the processor that the calling thread is busy-waiting
+inline void spin_relax()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  asm volatile("pause" ::: "memory");
+#elif defined(__GNUC__) && defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+
+// by default, atomic_wait() polls for about a microsecond, then yields its processor a few times before it parks.
+// with a single processor, polling would only delay the thread which will end the wait, so it yields immediately
+inline int default_atomic_wait_num_spins()
+{
+  static const int result = available_concurrency() > 1 ? 1024 : 0;
+  return result;
+}
+
+constexpr int default_atomic_wait_num_yields = 32;
+
+
+namespace atomic_wait_detail
+{
+
+
+// a parking_bucket counts the threads parked on the atomic objects which hash to it,
+// so that notification only enters the kernel when someone may be parked.
+// when futexes are unavailable, threads park on the bucket's condition variable instead
+//
+// C++20's std::atomic::wait is not used, because std::atomic::notify_one() and notify_all() access the atomic
+// object, which a woken waiter may already have destroyed, e.g. when the object is a member of a released latch
+struct alignas(64) parking_bucket
+{
+  std::atomic<int> num_parked;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+inline parking_bucket& bucket_for(const void* address)
+{
+  static parking_bucket buckets[64];
+
+  std::uintptr_t x = reinterpret_cast<std::uintptr_t>(address);
+  return buckets[(x >> 2 ^ x >> 8) % 64];
+}
+
+
+template<class T>
+inline bool has_value(const std::atomic<T>& a, T old)
+{
+  T current = a.load(std::memory_order_acquire);
+  return std::memcmp(&current, &old, sizeof(T)) == 0;
+}
+
+
+#ifdef __linux__
+
+// 4-byte objects park on the futex which they overlay
+template<class T>
+inline void park_impl(std::true_type, const std::atomic<T>& a, T old)
+{
+  int expected;
+  std::memcpy(&expected, &old, sizeof(int));
+
+  while(has_value(a, old))
+  {
+    syscall(SYS_futex, reinterpret_cast<const int*>(&a), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+  }
+}
+
+template<class T>
+inline void unpark_impl(std::true_type, const std::atomic<T>& a, int num_threads)
+{
+  syscall(SYS_futex, reinterpret_cast<const int*>(&a), FUTEX_WAKE_PRIVATE, num_threads, nullptr, nullptr, 0);
+}
+
+template<class T>
+using has_futex = std::integral_constant<bool, sizeof(std::atomic<T>) == sizeof(int) && sizeof(T) == sizeof(int)>;
+
+#else
+
+template<class T>
+using has_futex = std::false_type;
+
+#endif
+
+
+// other objects park on their bucket's condition variable
+template<class T>
+inline void park_impl(std::false_type, const std::atomic<T>& a, T old)
+{
+  parking_bucket& bucket = bucket_for(&a);
+
+  std::unique_lock<std::mutex> lock(bucket.mutex);
+  bucket.cv.wait(lock, [&]{ return !has_value(a, old); });
+}
+
+// because different objects may share a bucket, every parked thread must be woken
+template<class T>
+inline void unpark_impl(std::false_type, const std::atomic<T>& a, int)
+{
+  parking_bucket& bucket = bucket_for(&a);
+
+  std::lock_guard<std::mutex> lock(bucket.mutex);
+  bucket.cv.notify_all();
+}
+
+
+template<class T>
+inline void park(const std::atomic<T>& a, T old)
+{
+  parking_bucket& bucket = bucket_for(&a);
+
+  // register before checking the value one last time, which pairs with the fence in unpark()
+  bucket.num_parked.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  park_impl(has_futex<T>(), a, old);
+
+  bucket.num_parked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<class T>
+inline void unpark(const std::atomic<T>& a, int num_threads)
+{
+  // order the caller's modification of a before the check for parked threads
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if(bucket_for(&a).num_parked.load(std::memory_order_relaxed) > 0)
+  {
+    unpark_impl(has_futex<T>(), a, num_threads);
+  }
+}
+
+template<class T>
+inline void unpark_one(const std::atomic<T>& a)
+{
+  unpark(a, 1);
+}
+
+template<class T>
+inline void unpark_all(const std::atomic<T>& a)
+{
+  unpark(a, INT_MAX);
+}
+
+
+} // end atomic_wait_detail
+
+
+// atomic_wait() returns once a's value differs from old.
+//
+// the calling thread first polls a num_spins times, then polls num_yields times while yielding
+// its processor, and finally parks until a call to atomic_notify_one() or atomic_notify_all().
+// so, short waits never enter the kernel, while long waits do not burn processor time.
+// threads park on a futex when it is available, or on a condition variable otherwise
+template<class T>
+inline void atomic_wait(const std::atomic<T>& a, T old,
+                        int num_spins = default_atomic_wait_num_spins(),
+                        int num_yields = default_atomic_wait_num_yields)
+{
+  for(int i = 0; i < num_spins; ++i)
+  {
+    if(a.load(std::memory_order_acquire) != old) return;
+
+    spin_relax();
+  }
+
+  for(int i = 0; i < num_yields; ++i)
+  {
+    if(a.load(std::memory_order_acquire) != old) return;
+
+    std::this_thread::yield();
+  }
+
+  if(a.load(std::memory_order_acquire) != old) return;
+
+  atomic_wait_detail::park(a, old);
+}
+
+
+// atomic_notify_one() and atomic_notify_all() wake one or all threads parked in atomic_wait() on a
+// and should follow each modification of a for which waiters may be parked.
+// they do not access a itself, so a woken thread may destroy a while they execute
+template<class T>
+inline void atomic_notify_one(const std::atomic<T>& a)
+{
+  atomic_wait_detail::unpark_one(a);
+}
+
+template<class T>
+inline void atomic_notify_all(const std::atomic<T>& a)
+{
+  atomic_wait_detail::unpark_all(a);
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// returns the processors on which this process may execute, according to the process's affinity mask
+// when the mask is unavailable, the result contains every processor
+inline std::vector<int> affinity_cpus()
+{
+  std::vector<int> result;
+
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  // query the process rather than the calling thread, which may have been pinned to a subset of the process's processors
+  if(sched_getaffinity(getpid(), sizeof(set), &set) == 0)
+  {
+    for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if(CPU_ISSET(cpu, &set))
+      {
+        result.push_back(cpu);
+      }
+    }
+  }
+#endif
+
+  if(result.empty())
+  {
+    int num_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for(int i = 0; i < num_cpus; ++i)
+    {
+      result.push_back(i);
+    }
+  }
+
+  return result;
+}
+
+
+// converts a CFS quota and period into a number of processors, rounding up
+// returns 0 if the quota does not limit the number of processors
+inline size_t cpu_quota_to_concurrency(long long quota, long long period)
+{
+  if(quota <= 0 || period <= 0) return 0;
+
+  return static_cast<size_t>((quota + period - 1) / period);
+}
+
+
+// parses the contents of a cgroup v2 cpu.max file, e.g. "400000 100000" or "max 100000"
+// returns 0 if the file does not limit the number of processors
+inline size_t parse_cgroup_cpu_max(const std::string& contents)
+{
+  std::stringstream stream(contents);
+
+  std::string quota;
+  long long period = 0;
+
+  if(!(stream >> quota >> period) || quota == "max")
+  {
+    return 0;
+  }
+
+  try
+  {
+    return cpu_quota_to_concurrency(std::stoll(quota), period);
+  }
+  catch(...)
+  {
+    return 0;
+  }
+}
+
+
+// returns the first line of the given file, or an empty string if the file cannot be read
+inline std::string read_first_line(const std::string& filename)
+{
+  std::ifstream file(filename);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+
+// returns the limit on the number of processors imposed by the cgroup v2 cgroup in the given directory, or 0
+inline size_t cgroup_v2_cpu_limit(const std::string& directory)
+{
+  return parse_cgroup_cpu_max(read_first_line(directory + "/cpu.max"));
+}
+
+
+// returns the limit on the number of processors imposed by the cgroup v1 cpu cgroup in the given directory, or 0
+inline size_t cgroup_v1_cpu_limit(const std::string& directory)
+{
+  std::string quota = read_first_line(directory + "/cpu.cfs_quota_us");
+  std::string period = read_first_line(directory + "/cpu.cfs_period_us");
+
+  try
+  {
+    return cpu_quota_to_concurrency(std::stoll(quota), std::stoll(period));
+  }
+  catch(...)
+  {
+    return 0;
+  }
+}
+
+
+// returns the tightest limit imposed by the cgroup at path beneath the given mount point and by each of its ancestors, or 0
+inline size_t cgroup_hierarchy_cpu_limit(const std::string& mount, std::string path, size_t (*limit)(const std::string&))
+{
+  size_t result = 0;
+
+  while(true)
+  {
+    size_t l = limit(mount + path);
+
+    if(l != 0 && (result == 0 || l < result))
+    {
+      result = l;
+    }
+
+    if(path.empty()) break;
+
+    path.erase(path.rfind('/'));
+  }
+
+  return result;
+}
+
+
+// returns the limit on the number of processors imposed by the cgroups of this process, e.g. by a container's CPU quota
+// returns 0 if there is no such limit, or if it cannot be determined
+inline size_t cgroup_cpu_limit()
+{
+  size_t result = 0;
+
+#if defined(__linux__)
+  // each line of /proc/self/cgroup is "hierarchy-ID:controller-list:cgroup-path"
+  std::ifstream cgroups("/proc/self/cgroup");
+  std::string line;
+
+  while(std::getline(cgroups, line))
+  {
+    size_t first_colon = line.find(':');
+    size_t second_colon = line.find(':', first_colon + 1);
+
+    if(first_colon == std::string::npos || second_colon == std::string::npos) continue;
+
+    std::string controllers = line.substr(first_colon + 1, second_colon - first_colon - 1);
+    std::string path = line.substr(second_colon + 1);
+
+    if(path == "/") path.clear();
+
+    std::vector<size_t> limits;
+
+    if(controllers.empty())
+    {
+      // this is the cgroup v2 unified hierarchy
+      limits.push_back(cgroup_hierarchy_cpu_limit("/sys/fs/cgroup", path, cgroup_v2_cpu_limit));
+    }
+    else if(("," + controllers + ",").find(",cpu,") != std::string::npos)
+    {
+      // this is the cgroup v1 cpu controller, which may be mounted by itself or together with cpuacct
+      limits.push_back(cgroup_hierarchy_cpu_limit("/sys/fs/cgroup/cpu", path, cgroup_v1_cpu_limit));
+      limits.push_back(cgroup_hierarchy_cpu_limit("/sys/fs/cgroup/cpu,cpuacct", path, cgroup_v1_cpu_limit));
+    }
+
+    for(size_t l : limits)
+    {
+      if(l != 0 && (result == 0 || l < result))
+      {
+        result = l;
+      }
+    }
+  }
+#endif
+
+  return result;
+}
+
+
+// returns the number of threads this process can execute simultaneously
+// this is the number of processors in the process's affinity mask, further limited by its cgroup's CPU quota, if any
+// the result is computed once and is always at least 1
+inline size_t available_concurrency()
+{
+  static const size_t result = []
+  {
+    size_t num_cpus = affinity_cpus().size();
+    size_t limit = cgroup_cpu_limit();
+
+    return std::max<size_t>(1, limit ? std::min(num_cpus, limit) : num_cpus);
+  }();
+
+  return result;
+}
+
+
+} // end detail
+} // end agency
+
@@ -1,8 +1,16 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/detail/concurrency/variant_barrier.hpp>
 
+#include <cstdint>
 #include <functional>
+#include <new>
+#include <stdexcept>
+#include <memory>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -136,7 +144,383 @@ protected:
 };
 
 
-using barrier = blocking_barrier;
+// barrier_generation is the generation number of a barrier, which the last thread to arrive at the barrier bumps
+//
+// threads wait for the generation to change via atomic_wait(), so threads which arrive close together
+// never enter the kernel, while threads which wait for a long time do not burn processor time. when there are
+// more participants than processors, spinning would only delay the participants which have yet to arrive,
+// so waiting threads skip directly to yielding
+class barrier_generation
+{
+  public:
+    inline explicit barrier_generation(size_t num_threads)
+      : num_spins_(num_threads <= available_concurrency() ? default_atomic_wait_num_spins() : 0),
+        generation_(0)
+    {}
+
+    inline unsigned int load() const
+    {
+      return generation_.load(std::memory_order_acquire);
+    }
+
+    // bumps the generation number and wakes the threads waiting for it to change
+    inline void advance()
+    {
+      generation_.fetch_add(1);
+      atomic_notify_all(generation_);
+    }
+
+    inline void wait_for_change(unsigned int generation)
+    {
+      atomic_wait(generation_, generation, num_spins_);
+    }
+
+  private:
+    int                       num_spins_;
+    std::atomic<unsigned int> generation_;
+};
+
+
+// hybrid_barrier is a barrier whose waiting threads spin for a bounded time before they park
+//
+// a thread arriving at the barrier decrements a counter without taking a lock. the last thread to arrive
+// resets the counter and bumps the barrier's generation, for which the other threads wait as described by barrier_generation
+class hybrid_barrier
+{
+  public:
+    inline explicit hybrid_barrier(size_t num_threads)
+      : count_(num_threads),
+        unarrived_count_(num_threads),
+        generation_(num_threads)
+    {
+      if(num_threads == 0) throw std::invalid_argument("barrier: num_threads may not be 0.");
+    }
+
+    // define this to workaround nvcc's automatic execution space deduction for compiler-generated functions
+    inline ~hybrid_barrier() {}
+
+    inline size_t count() const
+    {
+      return count_;
+    }
+
+    inline void arrive_and_drop()
+    {
+      arrive();
+    }
+
+    inline void arrive_and_wait()
+    {
+      unsigned int generation = generation_.load();
+
+      if(!arrive())
+      {
+        generation_.wait_for_change(generation);
+      }
+    }
+
+  private:
+    // returns true if the caller was the last thread to arrive
+    inline bool arrive()
+    {
+      if(unarrived_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        // initialize the unarrived count variable before anyone can observe the new generation
+        unarrived_count_.store(count_, std::memory_order_relaxed);
+
+        generation_.advance();
+
+        return true;
+      }
+
+      return false;
+    }
+
+    size_t              count_;
+    std::atomic<size_t> unarrived_count_;
+    barrier_generation  generation_;
+};
+
+
+// static_barrier is a hybrid_barrier whose number of participants is known at compile time
+//
+// it is suited to small groups whose size is fixed by their type, such as those of static_concurrent_agent.
+// it requires no dispatch on the group's size, and a group of one participant never waits
+template<size_t num_threads>
+class static_barrier
+{
+  static_assert(num_threads > 0, "static_barrier: num_threads may not be 0.");
+
+  public:
+    // count is accepted for compatibility with other barriers and must equal num_threads
+    inline explicit static_barrier(size_t count = num_threads)
+      : unarrived_count_(num_threads),
+        generation_(num_threads)
+    {
+      if(count != num_threads) throw std::invalid_argument("static_barrier: count must equal num_threads.");
+    }
+
+    inline ~static_barrier() {}
+
+    inline static constexpr size_t count()
+    {
+      return num_threads;
+    }
+
+    inline void arrive_and_drop()
+    {
+      arrive();
+    }
+
+    inline void arrive_and_wait()
+    {
+      if(num_threads == 1) return;
+
+      unsigned int generation = generation_.load();
+
+      if(!arrive())
+      {
+        generation_.wait_for_change(generation);
+      }
+    }
+
+  private:
+    // returns true if the caller was the last thread to arrive
+    inline bool arrive()
+    {
+      if(unarrived_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        unarrived_count_.store(num_threads, std::memory_order_relaxed);
+
+        generation_.advance();
+
+        return true;
+      }
+
+      return false;
+    }
+
+    std::atomic<unsigned int> unarrived_count_;
+    barrier_generation        generation_;
+};
+
+
+// tree_barrier is a combining tree barrier, whose cost grows logarithmically with the number of participants
+//
+// rather than counting every arrival on a single shared counter, each arriving thread counts itself at one
+// of the leaves of a tree whose nodes each admit at most fan_in arrivals. the last thread to arrive at a node
+// continues on to the node's parent, so only a single thread reaches the root, and it completes the phase
+// by bumping the barrier's generation. the other threads wait for the generation as described by barrier_generation
+//
+// a thread begins at the leaf at which it last arrived, or at a leaf chosen by hashing its id, and moves on to the next leaf
+// when that one is full. so, a group whose threads repeatedly wait at the same barrier settles onto distinct leaves
+class tree_barrier
+{
+  public:
+    static const size_t fan_in = 4;
+
+    inline explicit tree_barrier(size_t num_threads)
+      : count_(num_threads),
+        generation_(num_threads)
+    {
+      if(num_threads == 0) throw std::invalid_argument("barrier: num_threads may not be 0.");
+
+      // lay out the tree level by level, beginning with the leaves
+      // each node of a level admits the arrivals of at most fan_in members of the level below
+      std::vector<unsigned int> capacities;
+      std::vector<size_t> parents;
+
+      size_t previous_level_begin = 0;
+      size_t previous_level_size = 0;
+      size_t level_width = num_threads;
+
+      while(true)
+      {
+        size_t level_begin = capacities.size();
+        size_t level_size = (level_width + fan_in - 1) / fan_in;
+
+        for(size_t i = 0; i < level_size; ++i)
+        {
+          size_t remaining = level_width - i * fan_in;
+          capacities.push_back(static_cast<unsigned int>(remaining < fan_in ? remaining : fan_in));
+          parents.push_back(static_cast<size_t>(no_parent));
+        }
+
+        for(size_t i = 0; i < previous_level_size; ++i)
+        {
+          parents[previous_level_begin + i] = level_begin + i / fan_in;
+        }
+
+        previous_level_begin = level_begin;
+        previous_level_size = level_size;
+        level_width = level_size;
+
+        if(level_size == 1) break;
+      }
+
+      num_leaves_ = (num_threads + fan_in - 1) / fan_in;
+
+      num_nodes_ = capacities.size();
+
+      // new[] need not honor node's alignment, so allocate an extra node's worth of bytes and align the nodes to cache lines
+      storage_.reset(new char[(num_nodes_ + 1) * sizeof(node)]);
+      std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(storage_.get()) % cache_line_size;
+      nodes_ = reinterpret_cast<node*>(storage_.get() + (cache_line_size - misalignment) % cache_line_size);
+
+      for(size_t i = 0; i < num_nodes_; ++i)
+      {
+        ::new(&nodes_[i]) node(capacities[i], parents[i]);
+      }
+    }
+
+    // define this to workaround nvcc's automatic execution space deduction for compiler-generated functions
+    inline ~tree_barrier()
+    {
+      for(size_t i = 0; i < num_nodes_; ++i)
+      {
+        nodes_[i].~node();
+      }
+    }
+
+    inline size_t count() const
+    {
+      return count_;
+    }
+
+    inline void arrive_and_drop()
+    {
+      arrive(generation_.load());
+    }
+
+    inline void arrive_and_wait()
+    {
+      unsigned int generation = generation_.load();
+
+      if(!arrive(generation))
+      {
+        generation_.wait_for_change(generation);
+      }
+    }
+
+  private:
+    static constexpr size_t no_parent = static_cast<size_t>(-1);
+    static constexpr size_t cache_line_size = 64;
+
+    // each node occupies its own cache line, so threads arriving at sibling nodes do not contend
+    struct alignas(cache_line_size) node
+    {
+      std::atomic<unsigned int> arrived;
+      unsigned int capacity;
+      size_t parent;
+
+      node(unsigned int capacity, size_t parent)
+        : arrived(0),
+          capacity(capacity),
+          parent(parent)
+      {}
+    };
+
+    static_assert(sizeof(node) == cache_line_size, "tree_barrier::node should occupy a single cache line.");
+
+    // a node's arrival count is never reset. instead, the count of arrivals at a node during the current
+    // phase is the node's total arrival count less the capacity times the generation
+    // unsigned arithmetic keeps this correct when the counts and generation wrap around
+    static unsigned int arrivals_this_phase(unsigned int arrived, const node& n, unsigned int generation)
+    {
+      return arrived - generation * n.capacity;
+    }
+
+    static size_t& leaf_hint()
+    {
+      static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+      return hint;
+    }
+
+    // returns true if the caller was the last thread to arrive
+    inline bool arrive(unsigned int generation)
+    {
+      size_t& hint = leaf_hint();
+      size_t i = hint % num_leaves_;
+
+      // find a leaf which has room for us
+      while(true)
+      {
+        node& leaf = nodes_[i];
+        unsigned int arrived = leaf.arrived.load(std::memory_order_relaxed);
+
+        if(arrivals_this_phase(arrived, leaf, generation) == leaf.capacity)
+        {
+          // this leaf is full, try the next one
+          i = (i + 1) % num_leaves_;
+          continue;
+        }
+
+        if(leaf.arrived.compare_exchange_weak(arrived, arrived + 1, std::memory_order_acq_rel))
+        {
+          hint = i;
+
+          if(arrivals_this_phase(arrived + 1, leaf, generation) != leaf.capacity)
+          {
+            // we weren't the last to arrive at this leaf
+            return false;
+          }
+
+          break;
+        }
+      }
+
+      // we were the last to arrive at node i, so continue on to its ancestors
+      for(size_t parent = nodes_[i].parent; parent != no_parent; parent = nodes_[parent].parent)
+      {
+        node& n = nodes_[parent];
+        unsigned int arrived = n.arrived.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+        if(arrivals_this_phase(arrived, n, generation) != n.capacity)
+        {
+          return false;
+        }
+      }
+
+      // we were the last to arrive at the root, so complete the phase
+      generation_.advance();
+
+      return true;
+    }
+
+    size_t                  count_;
+    size_t                  num_leaves_;
+    size_t                  num_nodes_;
+    std::unique_ptr<char[]> storage_;
+    node*                   nodes_;
+    barrier_generation      generation_;
+};
+
+
+// adaptive_barrier chooses its implementation according to the number of participants:
+// a hybrid_barrier for small groups, and a tree_barrier for large groups, whose participants
+// would otherwise contend on the hybrid_barrier's single counter
+class adaptive_barrier : private variant_barrier<hybrid_barrier, tree_barrier>
+{
+  private:
+    using super_t = variant_barrier<hybrid_barrier, tree_barrier>;
+
+  public:
+    static const size_t tree_barrier_threshold = 64;
+
+    inline explicit adaptive_barrier(size_t num_threads)
+      : super_t(num_threads < tree_barrier_threshold ? 0 : 1, num_threads)
+    {}
+
+    // define this to workaround nvcc's automatic execution space deduction for compiler-generated functions
+    inline ~adaptive_barrier() {}
+
+    using super_t::count;
+    using super_t::arrive_and_drop;
+    using super_t::arrive_and_wait;
+};
+
+
+using barrier = adaptive_barrier;
 
 
 } // end detail
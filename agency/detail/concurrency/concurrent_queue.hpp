@@ -1,11 +1,16 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/detail/concurrency/synchronic>
+#include <agency/detail/concurrency/atomic_wait.hpp>
 
 #include <queue>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 
 
 namespace agency
@@ -15,7 +20,7 @@ namespace detail
 
 
 // this type increments a counter when it is constructed
-// and decrements it upon destruction
+// and decrements it upon destruction, waking any thread waiting on the counter in wait_until_equal()
 template<class T>
 struct scope_bumper
 {
@@ -28,6 +33,7 @@ struct scope_bumper
   ~scope_bumper()
   {
     --counter_;
+    atomic_notify_all(counter_);
   }
 
   std::atomic<T>& counter_;
@@ -37,10 +43,9 @@ struct scope_bumper
 template<class T>
 void wait_until_equal(const std::atomic<T>& a, const T& value)
 {
-  // implement this with a spin loop
-  while(a != value)
+  for(T current = a.load(); current != value; current = a.load())
   {
-    // spin
+    atomic_wait(a, current);
   }
 }
 
@@ -53,17 +58,19 @@ enum queue_status
 };
 
 
+// atomic_wait_concurrent_queue guards a std::queue with a lock and
+// waits for items by waiting on the queue's status via atomic_wait()
 template<class T>
-class synchronic_concurrent_queue
+class atomic_wait_concurrent_queue
 {
   public:
-    synchronic_concurrent_queue()
+    atomic_wait_concurrent_queue()
       : num_poppers_(0),
         status_(open_and_empty)
     {
     }
 
-    ~synchronic_concurrent_queue()
+    ~atomic_wait_concurrent_queue()
     {
       close();
     }
@@ -77,7 +84,8 @@ class synchronic_concurrent_queue
         if(status_ == closed) return;
 
         // notify that we're closing
-        notifier_.notify_all(status_, (int)closed);
+        status_.store(closed);
+        atomic_notify_all(status_);
       }
       
       // wait until all the poppers have finished with wait_and_pop() 
@@ -103,7 +111,8 @@ class synchronic_concurrent_queue
 
       items_.emplace(std::forward<Args>(args)...);
 
-      notifier_.notify_one(status_, (int)open_and_ready); 
+      status_.store(open_and_ready);
+      atomic_notify_one(status_);
 
       return queue_status::open_and_ready;
     }
@@ -120,7 +129,7 @@ class synchronic_concurrent_queue
 
       while(true)
       {
-        notifier_.wait_for_change(status_, (int)open_and_empty);
+        atomic_wait(status_, (int)open_and_empty);
 
         {
           std::unique_lock<std::mutex> lock(mutex_);
@@ -138,7 +147,16 @@ class synchronic_concurrent_queue
             item = std::move(items_.front());
             items_.pop();
 
-            notifier_.notify_one(status_, (int)(items_.empty() ? open_and_empty : open_and_ready));
+            if(!items_.empty())
+            {
+              // let another popper know that items remain
+              status_.store(open_and_ready);
+              atomic_notify_one(status_);
+            }
+            else
+            {
+              status_.store(open_and_empty);
+            }
 
             return true;
           }
@@ -160,12 +178,7 @@ class synchronic_concurrent_queue
     std::mutex mutex_;
     std::atomic<int> num_poppers_;
 
-    // XXX synchronic<status> doesn't seem to work correctly
-    //std::atomic<status> status_;
-    //std::experimental::synchronic<status, std::experimental::synchronic_option::optimize_for_long_wait> notifier_;
-
     std::atomic<int> status_;
-    std::experimental::synchronic<int, std::experimental::synchronic_option::optimize_for_short_wait> notifier_;
 };
 
 
@@ -282,8 +295,306 @@ class condition_variable_concurrent_queue
 };
 
 
+// bounded_concurrent_queue is a lock-free multi-producer, multi-consumer queue of fixed capacity
+//
+// items are stored in a ring buffer whose cells each carry a sequence number which tells producers and consumers
+// whether the cell is ready to be written or read. producers and consumers claim cells by incrementing separate
+// counters, so neither emplace() nor wait_and_pop() takes a lock or allocates as long as the queue is neither full nor empty.
+// a consumer which finds the queue empty, or a producer which finds it full, spins briefly and then sleeps
+// on a condition variable. the other side only touches the condition variable's lock when someone is asleep
+template<class T>
+class bounded_concurrent_queue
+{
+  public:
+    // the capacity is rounded up to a power of two no smaller than two
+    explicit bounded_concurrent_queue(size_t capacity = 1024)
+      : mask_(round_up_to_power_of_two(capacity) - 1),
+        cells_(new cell[mask_ + 1]),
+        enqueue_position_(0),
+        dequeue_position_(0),
+        num_sleeping_producers_(0),
+        num_sleeping_consumers_(0),
+        num_poppers_(0),
+        is_closed_(false)
+    {
+      for(size_t i = 0; i <= mask_; ++i)
+      {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ~bounded_concurrent_queue()
+    {
+      close();
+
+      // destroy any items which were never popped
+      T item;
+      while(try_pop(item)) {}
+    }
+
+    void close()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        is_closed_.store(true);
+      }
+
+      // wake everyone up
+      not_empty_.notify_all();
+      not_full_.notify_all();
+
+      // wait until all the poppers have finished with wait_and_pop()
+      detail::wait_until_equal(num_poppers_, 0);
+    }
+
+    bool is_closed()
+    {
+      return is_closed_.load();
+    }
+
+    size_t capacity() const
+    {
+      return mask_ + 1;
+    }
+
+    // emplace() waits for space in the queue if it is full
+    template<class... Args>
+    queue_status emplace(Args&&... args)
+    {
+      for(size_t attempt = 0; ; ++attempt)
+      {
+        if(is_closed_.load(std::memory_order_relaxed))
+        {
+          return queue_status::closed;
+        }
+
+        if(try_emplace(std::forward<Args>(args)...))
+        {
+          wake_one(num_sleeping_consumers_, not_empty_);
+          return queue_status::open_and_ready;
+        }
+
+        if(attempt >= num_spins)
+        {
+          // the queue is full, so sleep until a consumer makes room
+          std::unique_lock<std::mutex> lock(mutex_);
+
+          ++num_sleeping_producers_;
+
+          not_full_.wait(lock, [this]
+          {
+            return is_closed_.load() || !full();
+          });
+
+          --num_sleeping_producers_;
+        }
+        else if(attempt >= num_spins / 2)
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    queue_status push(const T& item)
+    {
+      return emplace(item);
+    }
+
+    // XXX this should return queue_status
+    bool wait_and_pop(T& item)
+    {
+      scope_bumper<int> popping(num_poppers_);
+
+      for(size_t attempt = 0; ; ++attempt)
+      {
+        // if the queue is closed, return
+        if(is_closed_.load(std::memory_order_relaxed))
+        {
+          return false;
+        }
+
+        if(try_pop(item))
+        {
+          wake_one(num_sleeping_producers_, not_full_);
+          return true;
+        }
+
+        if(attempt >= num_spins)
+        {
+          // the queue is empty, so sleep until a producer adds an item
+          std::unique_lock<std::mutex> lock(mutex_);
+
+          ++num_sleeping_consumers_;
+
+          not_empty_.wait(lock, [this]
+          {
+            return is_closed_.load() || !empty();
+          });
+
+          --num_sleeping_consumers_;
+        }
+        else if(attempt >= num_spins / 2)
+        {
+          std::this_thread::yield();
+        }
+      }
+    }
+
+    // returns false without waiting if the queue is full
+    template<class... Args>
+    bool try_emplace(Args&&... args)
+    {
+      cell* c = nullptr;
+      size_t position = enqueue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        c = &cells_[position & mask_];
+        size_t sequence = c->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(difference == 0)
+        {
+          // the cell is free, so try to claim it
+          if(enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if(difference < 0)
+        {
+          // the cell still holds an item from the previous lap, so the queue is full
+          return false;
+        }
+        else
+        {
+          // another producer claimed the cell
+          position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+      }
+
+      new(&c->storage) T(std::forward<Args>(args)...);
+
+      // publish the item to consumers
+      c->sequence.store(position + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    // returns false without waiting if the queue is empty
+    bool try_pop(T& item)
+    {
+      cell* c = nullptr;
+      size_t position = dequeue_position_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        c = &cells_[position & mask_];
+        size_t sequence = c->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if(difference == 0)
+        {
+          // the cell holds an item, so try to claim it
+          if(dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if(difference < 0)
+        {
+          // the cell's item has not yet been published, so the queue is empty
+          return false;
+        }
+        else
+        {
+          // another consumer claimed the cell
+          position = dequeue_position_.load(std::memory_order_relaxed);
+        }
+      }
+
+      T* ptr = reinterpret_cast<T*>(&c->storage);
+      item = std::move(*ptr);
+      ptr->~T();
+
+      // release the cell to producers on the next lap
+      c->sequence.store(position + mask_ + 1, std::memory_order_release);
+
+      return true;
+    }
+
+  private:
+    static const size_t num_spins = 64;
+
+    // a single cell's sequence number cannot distinguish a full queue from an empty one, so use at least two
+    static size_t round_up_to_power_of_two(size_t n)
+    {
+      size_t result = 2;
+      while(result < n) result *= 2;
+      return result;
+    }
+
+    bool empty() const
+    {
+      return enqueue_position_.load() == dequeue_position_.load();
+    }
+
+    bool full() const
+    {
+      return enqueue_position_.load() - dequeue_position_.load() > mask_;
+    }
+
+    // wakes one thread sleeping on cv, but only touches the lock when num_sleeping indicates that someone is asleep
+    void wake_one(std::atomic<size_t>& num_sleeping, std::condition_variable& cv)
+    {
+      // order the preceding publication before the load of num_sleeping
+      // a thread going to sleep increments num_sleeping before it re-examines the queue
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if(num_sleeping.load() > 0)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv.notify_one();
+      }
+    }
+
+    struct cell
+    {
+      std::atomic<size_t> sequence;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    // pad the members touched by producers and consumers onto separate cache lines
+    static const size_t cache_line_size = 64;
+
+    const size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+    char pad0_[cache_line_size];
+
+    std::atomic<size_t> enqueue_position_;
+    char pad1_[cache_line_size - sizeof(std::atomic<size_t>)];
+
+    std::atomic<size_t> dequeue_position_;
+    char pad2_[cache_line_size - sizeof(std::atomic<size_t>)];
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<size_t> num_sleeping_producers_;
+    std::atomic<size_t> num_sleeping_consumers_;
+    std::atomic<int> num_poppers_;
+    std::atomic<bool> is_closed_;
+};
+
+
+// define AGENCY_LOCK_FREE_CONCURRENT_QUEUE to select bounded_concurrent_queue as the implementation of concurrent_queue
+#ifdef AGENCY_LOCK_FREE_CONCURRENT_QUEUE
+template<class T>
+using concurrent_queue = bounded_concurrent_queue<T>;
+#else
 template<class T>
-using concurrent_queue = synchronic_concurrent_queue<T>;
+using concurrent_queue = atomic_wait_concurrent_queue<T>;
+#endif
 
 
 } // end detail
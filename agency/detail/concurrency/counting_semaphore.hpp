@@ -0,0 +1,94 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// counting_semaphore is a semaphore whose acquiring threads spin briefly before they park via atomic_wait()
+//
+// release() enters the kernel only when some thread is parked in acquire()
+class counting_semaphore
+{
+  public:
+    inline explicit counting_semaphore(ptrdiff_t desired)
+      : count_(static_cast<int>(desired))
+    {
+      if(desired < 0 || desired > max()) throw std::invalid_argument("counting_semaphore: desired must lie within [0, max()].");
+    }
+
+    counting_semaphore(const counting_semaphore&) = delete;
+
+    static constexpr ptrdiff_t max()
+    {
+      return INT_MAX;
+    }
+
+    inline void release(ptrdiff_t update = 1)
+    {
+      count_.fetch_add(static_cast<int>(update), std::memory_order_release);
+
+      if(update == 1)
+      {
+        atomic_notify_one(count_);
+      }
+      else
+      {
+        atomic_notify_all(count_);
+      }
+    }
+
+    inline void acquire()
+    {
+      int count = count_.load(std::memory_order_relaxed);
+
+      while(true)
+      {
+        if(count > 0)
+        {
+          if(count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+          {
+            return;
+          }
+        }
+        else
+        {
+          atomic_wait(count_, count);
+          count = count_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    inline bool try_acquire()
+    {
+      int count = count_.load(std::memory_order_relaxed);
+
+      while(count > 0)
+      {
+        if(count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+  private:
+    std::atomic<int> count_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <agency/detail/type_traits.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// elastic_thread_pool is a pool of threads which guarantees that each submitted task
+// begins executing immediately, concurrently with every other task in the pool
+//
+// when a task is submitted and no idle thread is available to execute it,
+// the pool grows by creating a new thread. when a thread finishes its task,
+// it becomes idle and waits to be reused by a later submission. threads which
+// remain idle for longer than the pool's keep-alive duration retire
+//
+// because each task receives its own thread, tasks may safely block on each other,
+// e.g. via a barrier, which is required by concurrent execution agents
+class elastic_thread_pool
+{
+  private:
+    struct worker
+    {
+      std::thread thread;
+      std::condition_variable wake_up;
+      unique_function<void()> task;
+    };
+
+    using worker_iterator = typename std::list<worker>::iterator;
+
+  public:
+    explicit elastic_thread_pool(std::chrono::steady_clock::duration keep_alive = std::chrono::seconds(60))
+      : keep_alive_(keep_alive),
+        stopped_(false)
+    {}
+
+    ~elastic_thread_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        stopped_ = true;
+
+        for(worker* w : idle_workers_)
+        {
+          w->wake_up.notify_one();
+        }
+      }
+
+      // no new workers may be created at this point, so it is safe to traverse the list without the lock
+      for(worker& w : workers_)
+      {
+        if(w.thread.joinable()) w.thread.join();
+      }
+    }
+
+    // submit() executes f on a thread of its own
+    template<class Function,
+             class = result_of_t<Function()>>
+    inline void submit(Function&& f)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      reap_retired_workers();
+
+      assign_task(std::forward<Function>(f));
+    }
+
+    // bulk_submit() executes f(idx) for each idx in [0, n), each on a thread of its own
+    // if fewer than n threads are idle, the pool grows to accomodate the entire group
+    template<class Function>
+    inline void bulk_submit(size_t n, Function f)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      reap_retired_workers();
+
+      for(size_t idx = 0; idx < n; ++idx)
+      {
+        assign_task([=]() mutable
+        {
+          f(idx);
+        });
+      }
+    }
+
+    // returns the number of threads currently owned by the pool
+    inline size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return workers_.size() - retired_workers_.size();
+    }
+
+    // returns the number of threads currently waiting for a task
+    inline size_t num_idle_threads() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return idle_workers_.size();
+    }
+
+  private:
+    // the caller must own mutex_
+    template<class Function>
+    inline void assign_task(Function&& f)
+    {
+      if(!idle_workers_.empty())
+      {
+        // reuse the most recently idled thread
+        worker* w = idle_workers_.back();
+        idle_workers_.pop_back();
+
+        w->task = std::forward<Function>(f);
+        w->wake_up.notify_one();
+      }
+      else
+      {
+        // there are no idle threads, so grow the pool
+        workers_.emplace_back();
+        worker_iterator w = std::prev(workers_.end());
+
+        w->task = std::forward<Function>(f);
+        w->thread = std::thread([=]
+        {
+          work(w);
+        });
+      }
+    }
+
+    // the caller must own mutex_
+    inline void reap_retired_workers()
+    {
+      for(worker_iterator w : retired_workers_)
+      {
+        // a retired worker has already exited its loop, so this join returns promptly
+        w->thread.join();
+        workers_.erase(w);
+      }
+
+      retired_workers_.clear();
+    }
+
+    inline void work(worker_iterator self)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      while(true)
+      {
+        if(self->task)
+        {
+          unique_function<void()> task = std::move(self->task);
+          self->task = nullptr;
+
+          // execute the task outside of the lock
+          lock.unlock();
+          task();
+
+          // destroy the task's resources before becoming idle
+          task = nullptr;
+          lock.lock();
+
+          if(stopped_) break;
+
+          idle_workers_.push_back(&*self);
+        }
+
+        bool woken = self->wake_up.wait_for(lock, keep_alive_, [&]
+        {
+          return stopped_ || static_cast<bool>(self->task);
+        });
+
+        if(!woken)
+        {
+          // we've been idle for too long, so retire
+          idle_workers_.erase(std::find(idle_workers_.begin(), idle_workers_.end(), &*self));
+          retired_workers_.push_back(self);
+          break;
+        }
+
+        if(stopped_ && !self->task) break;
+      }
+    }
+
+    std::chrono::steady_clock::duration keep_alive_;
+
+    mutable std::mutex mutex_;
+    bool stopped_;
+
+    std::list<worker> workers_;
+    std::vector<worker*> idle_workers_;
+    std::vector<worker_iterator> retired_workers_;
+};
+
+
+inline elastic_thread_pool& system_elastic_thread_pool()
+{
+  static elastic_thread_pool resource;
+  return resource;
+}
+
+
+} // end detail
+} // end agency
+
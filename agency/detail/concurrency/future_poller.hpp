@@ -0,0 +1,148 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/unique_function.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// future_poller waits on behalf of work which depends on futures offering no way to register a continuation, e.g. std::future
+//
+// each piece of work is represented by a poll function, which checks whether the work's futures are ready and, if so,
+// dispatches the work and returns true. a single thread calls each pending poll function in turn until it returns true.
+// between rounds in which nothing becomes ready, the thread sleeps for intervals which grow from 10 us to 1 ms,
+// and while nothing is pending, it sleeps until something is added. so, no matter how much work is pending,
+// it occupies only the poller's thread
+class future_poller
+{
+  public:
+    future_poller()
+      : stopped_(false)
+    {}
+
+    future_poller(const future_poller&) = delete;
+
+    // work which is still pending when the poller is destroyed is discarded
+    ~future_poller()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+      }
+
+      wake_up_.notify_one();
+
+      if(thread_.joinable()) thread_.join();
+    }
+
+    // poll must not block, and is called by the poller's thread until it returns true
+    template<class Function>
+    void add(Function&& poll)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // start the thread upon first use, so a program which never polls never pays for it
+        if(!thread_.joinable())
+        {
+          thread_ = std::thread([this]
+          {
+            run();
+          });
+        }
+
+        incoming_.emplace_back(std::forward<Function>(poll));
+      }
+
+      wake_up_.notify_one();
+    }
+
+  private:
+    using poll_function = unique_function<bool()>;
+
+    void run()
+    {
+      const std::chrono::microseconds min_interval(10);
+      const std::chrono::microseconds max_interval(1000);
+
+      // pending is only touched by this thread, so polling occurs outside of the lock
+      std::vector<poll_function> pending;
+      std::chrono::microseconds interval = min_interval;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      while(!stopped_)
+      {
+        std::move(incoming_.begin(), incoming_.end(), std::back_inserter(pending));
+        incoming_.clear();
+
+        if(pending.empty())
+        {
+          wake_up_.wait(lock, [this]
+          {
+            return stopped_ || !incoming_.empty();
+          });
+
+          interval = min_interval;
+          continue;
+        }
+
+        lock.unlock();
+
+        size_t num_pending = pending.size();
+
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [](poll_function& poll)
+        {
+          return poll();
+        }), pending.end());
+
+        lock.lock();
+
+        if(pending.size() < num_pending)
+        {
+          // something became ready, so the rest may follow soon
+          interval = min_interval;
+        }
+        else
+        {
+          wake_up_.wait_for(lock, interval, [this]
+          {
+            return stopped_ || !incoming_.empty();
+          });
+
+          interval = std::min(2 * interval, max_interval);
+        }
+      }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_up_;
+    bool stopped_;
+    std::vector<poll_function> incoming_;
+    std::thread thread_;
+};
+
+
+inline future_poller& system_future_poller()
+{
+  static future_poller resource;
+  return resource;
+}
+
+
+} // end detail
+} // end agency
+
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/detail/concurrency/synchronic>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/wait_helper.hpp>
 
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <cstddef>
+#include <stdexcept>
 
 
 namespace agency
@@ -14,21 +17,27 @@ namespace detail
 {
 
 
-class synchronic_latch
+// atomic_wait_latch is a latch whose waiting threads spin briefly before they park via atomic_wait()
+class atomic_wait_latch
 {
   public:
-    inline explicit synchronic_latch(ptrdiff_t count)
+    inline explicit atomic_wait_latch(ptrdiff_t count)
       : counter_(count),
-        released_(false)
+        released_(0)
     {
-      if(counter_ == 0) throw std::invalid_argument("latch: count may not be 0.");
+      if(count == 0) throw std::invalid_argument("latch: count may not be 0.");
     }
 
     inline void count_down(ptrdiff_t n)
     {
-      if((counter_ -= n) == 0)
+      if(counter_.fetch_sub(n, std::memory_order_acq_rel) == n)
       {
-        notifier_.notify_all(released_, true);
+        released_.store(1, std::memory_order_release);
+
+        // a waiting thread may destroy this latch as soon as released_ is set,
+        // so notify without touching this object
+        atomic_notify_all(released_);
+        notify_parked_helpers();
       }
     }
 
@@ -40,21 +49,21 @@ class synchronic_latch
 
     inline void wait()
     {
-      if(!is_ready())
+      // a thread with a wait_helper, e.g. a thread of a pool, helps execute other work rather than blocking
+      if(!try_help_until([this]{ return is_ready(); }))
       {
-        notifier_.wait(released_, true);
+        atomic_wait(released_, 0);
       }
     }
 
     inline bool is_ready() const
     {
-      return counter_ == 0;
+      return released_.load(std::memory_order_acquire) != 0;
     }
 
   private:
-    std::atomic<size_t> counter_;
-    std::atomic<bool> released_;
-    std::experimental::synchronic<bool, std::experimental::synchronic_option::optimize_for_short_wait> notifier_;
+    std::atomic<ptrdiff_t> counter_;
+    std::atomic<int> released_;
 };
 
 
@@ -77,6 +86,7 @@ class condition_variable_latch
       {
         // unblock all blocking threads
         cv_.notify_all();
+        notify_parked_helpers();
       }
     }
 
@@ -88,6 +98,12 @@ class condition_variable_latch
 
     inline void wait()
     {
+      // a thread with a wait_helper, e.g. a thread of a pool, helps execute other work rather than blocking
+      if(try_help_until([this]{ return is_ready(); }))
+      {
+        return;
+      }
+
       std::unique_lock<std::mutex> lock(mutex_);
 
       if(!unsafe_is_ready())
@@ -114,8 +130,9 @@ class condition_variable_latch
 };
 
 
-// condition_variable_latch is much faster than synchronic_latch for some reason
-using latch = condition_variable_latch;
+// atomic_wait_latch wakes its waiters with lower latency than condition_variable_latch
+// see benchmarks/wake_latency.cpp
+using latch = atomic_wait_latch;
 
 
 } // end detail
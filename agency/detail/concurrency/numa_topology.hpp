@@ -0,0 +1,150 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// numa_node describes the processors belonging to a single NUMA node
+struct numa_node
+{
+  // the operating system's identifier for this node
+  size_t id;
+
+  // the operating system's identifiers for this node's processors
+  std::vector<int> cpus;
+};
+
+
+// parses a Linux cpu list, e.g. "0-3,8-11", into the list of integers it describes
+// throws std::invalid_argument if the list is malformed
+inline std::vector<int> parse_cpu_list(const std::string& list)
+{
+  std::vector<int> result;
+
+  std::stringstream stream(list);
+  std::string range;
+
+  while(std::getline(stream, range, ','))
+  {
+    // ignore surrounding whitespace, including the trailing newline
+    range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }), range.end());
+
+    if(range.empty()) continue;
+
+    size_t dash = range.find('-');
+
+    int first = std::stoi(range.substr(0, dash));
+    int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+
+    for(int i = first; i <= last; ++i)
+    {
+      result.push_back(i);
+    }
+  }
+
+  return result;
+}
+
+
+// returns the machine's NUMA nodes which have processors available to this process, as described by /sys/devices/system/node
+// each node's processors are limited to those in the process's affinity mask
+// when this description is unavailable, the result is a single node containing every available processor
+inline std::vector<numa_node> numa_topology()
+{
+  std::vector<numa_node> result;
+
+  std::vector<int> available_cpus = affinity_cpus();
+
+  try
+  {
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string node_list;
+
+    if(std::getline(online, node_list))
+    {
+      for(int id : parse_cpu_list(node_list))
+      {
+        std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string cpu_list;
+
+        if(std::getline(cpulist, cpu_list))
+        {
+          numa_node node{static_cast<size_t>(id), std::vector<int>()};
+
+          for(int cpu : parse_cpu_list(cpu_list))
+          {
+            if(std::find(available_cpus.begin(), available_cpus.end(), cpu) != available_cpus.end())
+            {
+              node.cpus.push_back(cpu);
+            }
+          }
+
+          // skip nodes which have memory but no processors available to us
+          if(!node.cpus.empty())
+          {
+            result.push_back(node);
+          }
+        }
+      }
+    }
+  }
+  catch(...)
+  {
+    // the description was malformed, so fall back to a single node
+    result.clear();
+  }
+
+  if(result.empty())
+  {
+    result.push_back(numa_node{0, available_cpus});
+  }
+
+  return result;
+}
+
+
+// restricts the calling thread to execute on the given processors
+// returns false if the thread could not be pinned
+inline bool pin_this_thread(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for(int cpu : cpus)
+  {
+    if(0 <= cpu && cpu < CPU_SETSIZE)
+    {
+      CPU_SET(cpu, &set);
+    }
+  }
+
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+
+} // end detail
+} // end agency
+
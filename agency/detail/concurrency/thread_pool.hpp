@@ -1,22 +1,25 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/execution/executor/parallel_executor.hpp>
-#include <agency/execution/executor/vector_executor.hpp>
-#include <agency/execution/executor/scoped_executor.hpp>
-#include <agency/execution/executor/flattened_executor.hpp>
-#include <agency/execution/executor/properties/bulk_guarantee.hpp>
-#include <agency/detail/concurrency/latch.hpp>
-#include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <agency/detail/concurrency/work_stealing_deque.hpp>
+#include <agency/detail/concurrency/numa_topology.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/counting_semaphore.hpp>
+#include <agency/detail/concurrency/wait_helper.hpp>
 #include <agency/detail/unique_function.hpp>
-#include <agency/future.hpp>
 #include <agency/detail/type_traits.hpp>
 
 #include <thread>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <functional>
 
 
 namespace agency
@@ -25,7 +28,65 @@ namespace detail
 {
 
 
-class thread_pool
+// returns the number of threads a thread_pool creates by default
+// this is the value of the AGENCY_NUM_THREADS environment variable, if it is a positive integer,
+// and otherwise the number of threads this process can execute simultaneously
+inline size_t default_thread_pool_size()
+{
+  if(const char* env = std::getenv("AGENCY_NUM_THREADS"))
+  {
+    char* end = nullptr;
+    unsigned long n = std::strtoul(env, &end, 10);
+
+    if(end != env && *end == '\0' && n > 0)
+    {
+      return static_cast<size_t>(n);
+    }
+  }
+
+  return available_concurrency();
+}
+
+
+// task_priority orders the tasks of a thread_pool
+// a worker always executes the most urgent task it can find, so tasks of higher priority skip past queued tasks of lower priority
+enum class task_priority : unsigned char
+{
+  low,
+  normal,
+  high
+};
+
+constexpr size_t num_task_priorities = 3;
+
+
+// thread_pool is a work-stealing pool of threads
+//
+// each worker thread owns a deque of tasks and an inbox of tasks. tasks submitted from outside the pool
+// are distributed among the workers' inboxes in round-robin order, so submitting
+// threads never contend on a single shared lock. a worker whose deque and inbox are empty
+// attempts to steal work from the other workers, beginning at a randomly chosen victim.
+// when no work can be found anywhere in the pool, a worker goes to sleep until new work is submitted
+//
+// tasks submitted by a worker are pushed onto that worker's own deque, and a worker pops the most recently
+// pushed task first. so, nested work remains local to the worker which created it unless idle workers steal it.
+// by contrast, an inbox is first-in-first-out, so tasks submitted from outside the pool begin in the order of their
+// submission, and a task submitted early is never starved by later submissions.
+// because a worker's nested work may be queued behind it, a worker must never block waiting on the pool's work.
+// instead, it should help execute queued tasks via help_until(). the pool is the wait_helper of each of its workers,
+// so a worker which waits via try_help_until(), as latches do, helps automatically
+//
+// a pool constructed from a NUMA topology groups its workers by node and pins each worker to its node's processors.
+// each node additionally owns a queue of tasks which must execute on that node, see submit(node, f). a worker
+// looks for work on its own node before it steals from the workers of other nodes, so stealing across nodes
+// happens only when a worker's node has no work to offer. tasks in a node's queue are never stolen across nodes
+//
+// each task has a task_priority, and each deque and queue above is really one deque per priority. a worker searches
+// for work of each priority in turn, beginning with the highest. a task submitted by a worker inherits the priority
+// of the worker's current task unless a priority is given explicitly
+//
+// a worker which finds no work waits according to the pool's idle_policy
+class thread_pool : private wait_helper
 {
   private:
     struct joining_thread : std::thread
@@ -40,43 +101,191 @@ class thread_pool
       }
     };
 
+    using task_type = unique_function<void()>;
+    using deque_type = work_stealing_deque<task_type>;
+
+    // worker_context identifies the pool and deque of the calling thread, and the priority of its current task
+    struct worker_context
+    {
+      thread_pool* pool;
+      size_t index;
+      std::minstd_rand rng;
+      task_priority priority;
+    };
+
+    static worker_context& this_worker()
+    {
+      static thread_local worker_context context{nullptr, 0, std::minstd_rand(), task_priority::normal};
+      return context;
+    }
+
+    // worker_state holds a worker's deques and inboxes, one of each for each priority
+    struct worker_state
+    {
+      // tasks submitted by this worker, popped last-in-first-out
+      deque_type deques[num_task_priorities];
+
+      // tasks submitted from outside the pool, popped first-in-first-out
+      deque_type inboxes[num_task_priorities];
+
+      size_t node;
+
+      explicit worker_state(size_t node)
+        : node(node)
+      {}
+    };
+
+    // node_state describes a group of workers which share a NUMA node
+    struct node_state
+    {
+      // the operating system's identifier for this node
+      size_t id;
+
+      // the processors to which this node's workers are pinned; empty if the workers are not pinned
+      std::vector<int> cpus;
+
+      // this node's workers are the contiguous range [first_worker, first_worker + num_workers)
+      size_t first_worker;
+      size_t num_workers;
+
+      // tasks which must execute on one of this node's workers, one queue for each priority
+      deque_type queues[num_task_priorities];
+      std::atomic<size_t> num_queued_tasks;
+
+      // the number of this node's workers which are asleep and have not yet been claimed by a waker
+      // a waker claims a sleeper by decrementing this count and then releases wake_up once on its behalf
+      std::atomic<size_t> num_sleeping_threads;
+      counting_semaphore wake_up;
+
+      node_state(size_t id, const std::vector<int>& cpus, size_t first_worker, size_t num_workers)
+        : id(id),
+          cpus(cpus),
+          first_worker(first_worker),
+          num_workers(num_workers),
+          num_queued_tasks(0),
+          num_sleeping_threads(0),
+          wake_up(0)
+      {}
+    };
+
   public:
-    explicit thread_pool(size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
+    // idle_policy describes how an idle worker waits for work
+    // first, the worker polls for work num_spins times in a busy loop. next, it polls num_yields more times,
+    // yielding its processor between polls. finally, it parks, sleeping until new work is submitted.
+    // spinning shortens the time to dispatch new work to an idle worker but keeps its processor busy, while
+    // parking immediately frees the processor for other jobs
+    struct idle_policy
     {
-      for(size_t i = 0; i < num_threads; ++i)
+      size_t num_spins;
+      size_t num_yields;
+
+      constexpr idle_policy(size_t num_spins = 0, size_t num_yields = 0)
+        : num_spins(num_spins),
+          num_yields(num_yields)
+      {}
+    };
+
+    explicit thread_pool(size_t num_threads = default_thread_pool_size(), idle_policy policy = idle_policy())
+      : num_sleeping_threads_(0),
+        next_worker_(0),
+        num_idle_spins_(policy.num_spins),
+        num_idle_yields_(policy.num_yields),
+        stopped_(false)
+    {
+      // the workers of this pool are not pinned, so place them all in a single node
+      add_node(0, std::vector<int>(), num_threads);
+
+      start();
+    }
+
+    // creates one worker for each processor of topology, pinned to the processors of its node
+    explicit thread_pool(const std::vector<numa_node>& topology, idle_policy policy = idle_policy())
+      : num_sleeping_threads_(0),
+        next_worker_(0),
+        num_idle_spins_(policy.num_spins),
+        num_idle_yields_(policy.num_yields),
+        stopped_(false)
+    {
+      for(const numa_node& node : topology)
       {
-        threads_.emplace_back([this]
-        {
-          work();
-        });
+        add_node(node.id, node.cpus, node.cpus.size());
       }
+
+      start();
     }
     
     ~thread_pool()
     {
-      tasks_.close();
+      stopped_ = true;
+
+      // wake everyone up so they may drain their deques and exit
+      // a worker which goes to sleep after this point notices stopped_ before it blocks
+      for(auto& node : nodes_)
+      {
+        while(try_claim_sleeper(*node))
+        {
+          node->wake_up.release();
+        }
+      }
+
       threads_.clear();
     }
 
+    // submits f with the priority of the calling worker's current task, or with normal priority
+    // if the calling thread is not one of this pool's threads
     template<class Function,
              class = result_of_t<Function()>>
     inline void submit(Function&& f)
     {
-      auto is_this_thread = [=](const joining_thread& t)
-      {
-        return t.get_id() == std::this_thread::get_id();
-      };
+      submit(inherited_priority(), std::forward<Function>(f));
+    }
 
-      // guard against self-submission which may result in deadlock
-      // XXX it might be faster to compare this to a thread_local variable
-      if(std::find_if(threads_.begin(), threads_.end(), is_this_thread) == threads_.end())
+    template<class Function,
+             class = result_of_t<Function()>>
+    inline void submit(task_priority priority, Function&& f)
+    {
+      if(is_worker_thread())
       {
-        tasks_.emplace(std::forward<Function>(f));
+        // keep nested work local to the submitting worker
+        size_t worker_idx = this_worker().index;
+
+        push(worker_idx, workers_[worker_idx]->deques[index_of(priority)], priority, std::forward<Function>(f));
       }
       else
       {
-        // the submitting thread is part of this pool so execute immediately 
-        std::forward<Function>(f)();
+        // distribute tasks among the workers' inboxes in round-robin order
+        size_t worker_idx = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+        push(worker_idx, workers_[worker_idx]->inboxes[index_of(priority)], priority, std::forward<Function>(f));
+      }
+    }
+
+    // submits f to the queue of the given node, so that only that node's workers execute f
+    template<class Function,
+             class = result_of_t<Function()>>
+    inline void submit(size_t node, Function&& f)
+    {
+      submit(node, inherited_priority(), std::forward<Function>(f));
+    }
+
+    template<class Function,
+             class = result_of_t<Function()>>
+    inline void submit(size_t node, task_priority priority, Function&& f)
+    {
+      node_state& n = *nodes_[node];
+
+      // count the task before it becomes visible to the node's workers, as push() does
+      n.num_queued_tasks.fetch_add(1);
+
+      n.queues[index_of(priority)].emplace_back(std::forward<Function>(f));
+
+      // a worker of the node may be parked in help_until()
+      notify_parked_helpers();
+
+      // only this node's workers may execute the task, so don't wake anyone else
+      if(num_sleeping_threads_.load() > 0 && try_claim_sleeper(n))
+      {
+        n.wake_up.release();
       }
     }
 
@@ -85,6 +294,121 @@ class thread_pool
       return threads_.size();
     }
 
+    // returns the number of NUMA nodes spanned by this pool's workers
+    inline size_t num_nodes() const
+    {
+      return nodes_.size();
+    }
+
+    // the functions below identify a node by its position in [0, num_nodes()), which differs from the
+    // operating system's identifier for the node when the pool's topology omits some of the machine's nodes
+
+    // returns the number of workers belonging to the given node
+    inline size_t node_size(size_t node) const
+    {
+      return nodes_[node]->num_workers;
+    }
+
+    // returns the operating system's identifier for the given node
+    inline size_t node_id(size_t node) const
+    {
+      return nodes_[node]->id;
+    }
+
+    // returns the position of the node whose operating system identifier is id, or num_nodes() if there is no such node
+    inline size_t find_node(size_t id) const
+    {
+      for(size_t node = 0; node < nodes_.size(); ++node)
+      {
+        if(nodes_[node]->id == id) return node;
+      }
+
+      return nodes_.size();
+    }
+
+    inline idle_policy get_idle_policy() const
+    {
+      return idle_policy(num_idle_spins_.load(std::memory_order_relaxed), num_idle_yields_.load(std::memory_order_relaxed));
+    }
+
+    // workers which are already idle adopt the new policy the next time they find no work
+    inline void set_idle_policy(const idle_policy& policy)
+    {
+      num_idle_spins_.store(policy.num_spins, std::memory_order_relaxed);
+      num_idle_yields_.store(policy.num_yields, std::memory_order_relaxed);
+    }
+
+    // returns true if the calling thread is one of this pool's threads
+    inline bool is_worker_thread() const
+    {
+      return this_worker().pool == this;
+    }
+
+    // returns the pool which owns the calling thread, or nullptr if the calling thread is not part of a pool
+    static thread_pool* current()
+    {
+      return this_worker().pool;
+    }
+
+    // help_until() executes this pool's queued tasks on the calling thread until ready() returns true
+    // the calling thread must be one of this pool's threads
+    //
+    // when there is nothing to help with, the calling thread polls according to the idle policy and then parks
+    // until either new work arrives or ready() becomes true. so, anything which makes ready() true must
+    // afterward call notify_parked_helpers(), as latches and thread_pool_futures do
+    template<class Predicate>
+    inline void help_until(Predicate ready)
+    {
+      worker_context& self = this_worker();
+      const node_state& node = *nodes_[workers_[self.index]->node];
+
+      // restore the priority of the task we're helping on behalf of when we're finished
+      task_priority waiting_priority = self.priority;
+
+      task_type task;
+      size_t num_polls = 0;
+
+      while(!ready())
+      {
+        if(try_pop(self.index, self.rng, task, self.priority))
+        {
+          task();
+
+          // destroy the task's resources before checking whether we're ready
+          task = nullptr;
+
+          num_polls = 0;
+          continue;
+        }
+
+        size_t num_spins = num_idle_spins_.load(std::memory_order_relaxed);
+
+        if(num_polls < num_spins + num_idle_yields_.load(std::memory_order_relaxed))
+        {
+          // there's nothing to help with, so poll for a while before parking
+          if(num_polls < num_spins)
+          {
+            spin_relax();
+          }
+          else
+          {
+            std::this_thread::yield();
+          }
+
+          ++num_polls;
+        }
+        else
+        {
+          park_helper_until([&]
+          {
+            return ready() || has_queued_tasks(node);
+          });
+        }
+      }
+
+      self.priority = waiting_priority;
+    }
+
     template<class Function, class... Args>
     std::future<result_of_t<Function(Args...)>>
       async(Function&& f, Args&&... args)
@@ -108,215 +432,363 @@ class thread_pool
 
 
   private:
-    inline void work()
+    // the wait_helper interface used by try_help_until()
+    virtual void help_until(bool (*ready)(const void*), const void* ready_arg) override
     {
-      unique_function<void()> task;
-
-      while(tasks_.wait_and_pop(task))
+      help_until([=]
       {
-        task();
-      }
+        return ready(ready_arg);
+      });
     }
 
-    agency::detail::concurrent_queue<unique_function<void()>> tasks_;
-    std::vector<joining_thread> threads_;
-};
-
-
-
-inline thread_pool& system_thread_pool()
-{
-  static thread_pool resource;
-  return resource;
-}
+    static size_t index_of(task_priority priority)
+    {
+      return static_cast<size_t>(priority);
+    }
 
+    inline task_priority inherited_priority() const
+    {
+      return is_worker_thread() ? this_worker().priority : task_priority::normal;
+    }
 
-class thread_pool_executor
-{
-  public:
-    constexpr static bulk_guarantee_t::parallel_t query(bulk_guarantee_t)
+    inline void add_node(size_t id, const std::vector<int>& cpus, size_t num_workers)
     {
-      return bulk_guarantee.parallel;
+      nodes_.emplace_back(new node_state(id, cpus, workers_.size(), num_workers));
+
+      for(size_t i = 0; i < num_workers; ++i)
+      {
+        workers_.emplace_back(new worker_state(nodes_.size() - 1));
+      }
     }
 
-    friend constexpr bool operator==(const thread_pool_executor&, const thread_pool_executor&) noexcept
+    inline void start()
     {
-      // currently, all thread_pool_executors compare equal because they all refer to the
-      // system_thread_pool
-      return true;
+      for(auto& count : num_queued_tasks_)
+      {
+        count.store(0);
+      }
+
+      // every worker's deques exist before any worker begins stealing from them
+      for(size_t i = 0; i < workers_.size(); ++i)
+      {
+        threads_.emplace_back([=]
+        {
+          work(i);
+        });
+      }
     }
 
-    friend constexpr bool operator!=(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
+    // pushes f onto the given deque or inbox of the given worker
+    template<class Function>
+    inline void push(size_t worker_idx, deque_type& deque, task_priority priority, Function&& f)
     {
-      return !(a == b);
+      // count the task before it becomes visible to the workers so that
+      // a worker which observes no queued tasks may safely go to sleep
+      num_queued_tasks_[index_of(priority)].fetch_add(1);
+
+      deque.emplace_back(std::forward<Function>(f));
+
+      // a worker may be parked in help_until()
+      notify_parked_helpers();
+
+      // only visit the nodes when there is someone to wake
+      if(num_sleeping_threads_.load() > 0)
+      {
+        // prefer to wake a worker on the same node as the deque
+        size_t num_nodes = nodes_.size();
+        size_t home = workers_[worker_idx]->node;
+
+        for(size_t i = 0; i < num_nodes; ++i)
+        {
+          node_state& n = *nodes_[(home + i) % num_nodes];
+
+          if(try_claim_sleeper(n))
+          {
+            n.wake_up.release();
+            break;
+          }
+        }
+      }
     }
 
-  private:
-    // this deleter fulfills a promise just before
-    // it deletes its argument
-    template<class ResultType>
-    struct fulfill_promise_and_delete
+    // tries to steal a task of the given priority from one of the workers in [first, first + count), beginning at a random victim
+    inline bool try_steal(size_t first, size_t count, size_t worker_idx, size_t level, std::minstd_rand& rng, task_type& task)
     {
-      std::shared_ptr<std::promise<ResultType>> shared_promise_ptr;
+      size_t first_victim = rng() % count;
 
-      void operator()(ResultType* ptr_to_result)
+      for(size_t i = 0; i < count; ++i)
       {
-        // move the result object into the promise
-        shared_promise_ptr->set_value(std::move(*ptr_to_result));
+        size_t victim = first + (first_victim + i) % count;
 
-        // delete the pointer
-        delete ptr_to_result;
+        if(victim != worker_idx &&
+           (workers_[victim]->deques[level].try_steal(task) || workers_[victim]->inboxes[level].try_steal(task)))
+        {
+          return true;
+        }
       }
-    };
-    
 
-  public:
-    // this is the overload of bulk_then_execute for non-void Future
-    template<class Function, class Future, class ResultFactory, class SharedFactory,
-             __AGENCY_REQUIRES(!std::is_void<future_result_t<Future>>::value)
-            >
-    std::future<
-      result_of_t<ResultFactory()>
-    >
-      bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
+      return false;
+    }
+
+    // tries to find a task of the given priority for the given worker, searching from the nearest work to the farthest:
+    // this worker's deque, its inbox, its node's queue, the deques and inboxes of its node's workers,
+    // and finally the deques and inboxes of every other worker
+    // a task which is found is removed from the count of queued tasks
+    inline bool try_pop(size_t worker_idx, size_t level, std::minstd_rand& rng, task_type& task)
     {
-      using result_type = result_of_t<ResultFactory()>;
+      worker_state& worker = *workers_[worker_idx];
+      node_state& node = *nodes_[worker.node];
 
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
+      // look in our own deque first, beginning with the most recently pushed task
+      if(worker.deques[level].try_pop_back(task))
+      {
+        num_queued_tasks_[level].fetch_sub(1);
+        return true;
+      }
 
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
+      // next, look in our inbox, beginning with the earliest submitted task
+      if(worker.inboxes[level].try_pop_front(task))
+      {
+        num_queued_tasks_[level].fetch_sub(1);
+        return true;
+      }
 
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
+      if(node.queues[level].try_pop_front(task))
+      {
+        node.num_queued_tasks.fetch_sub(1);
+        return true;
+      }
 
-      // create the shared state for the result
-      // note that we use our special deleter with this state
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+      // don't bother visiting the other workers if none of them has a task of this priority
+      if(num_queued_tasks_[level].load() == 0)
+      {
+        return false;
+      }
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+      if(try_steal(node.first_worker, node.num_workers, worker_idx, level, rng, task) ||
+         (nodes_.size() > 1 && try_steal(0, workers_.size(), worker_idx, level, rng, task)))
+      {
+        num_queued_tasks_[level].fetch_sub(1);
+        return true;
+      }
 
-      // share the incoming future
-      auto shared_predecessor = future_traits<Future>::share(predecessor);
+      return false;
+    }
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
+    // tries to find the most urgent task available to the given worker and returns its priority through priority
+    inline bool try_pop(size_t worker_idx, std::minstd_rand& rng, task_type& task, task_priority& priority)
+    {
+      for(size_t level = num_task_priorities; level-- > 0;)
       {
-        system_thread_pool().submit([=]() mutable
+        if(try_pop(worker_idx, level, rng, task))
         {
-// nvcc makes this lambda's constructors __host__ __device__ when
-// any of its captures' constructors are __host__ __device__. This causes nvcc
-// to emit warnings about a __host__ __device__ function calling __host__ functions 
-// this #ifndef works around this problem
-#ifndef __CUDA_ARCH__
-          // get the predecessor future's result
-          using predecessor_type = future_result_t<Future>;
-          predecessor_type& predecessor_arg = const_cast<predecessor_type&>(shared_predecessor.get());
-
-          // call the user's function
-          f(idx, predecessor_arg, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
-#endif
-        });
+          priority = static_cast<task_priority>(level);
+          return true;
+        }
       }
 
-      // return the result future
-      return std::move(result_future);
+      return false;
     }
 
+    // claims one of node's sleeping workers for waking, returning false if none is asleep
+    // the caller must then release node.wake_up once
+    static bool try_claim_sleeper(node_state& node)
+    {
+      size_t num_sleeping = node.num_sleeping_threads.load();
+
+      while(num_sleeping > 0)
+      {
+        if(node.num_sleeping_threads.compare_exchange_weak(num_sleeping, num_sleeping - 1))
+        {
+          return true;
+        }
+      }
+
+      return false;
+    }
 
-    // this is the overload of bulk_then_execute for void Future
-    template<class Function, class Future, class ResultFactory, class SharedFactory,
-             __AGENCY_REQUIRES(std::is_void<future_result_t<Future>>::value)
-            >
-    std::future<
-      result_of_t<ResultFactory()>
-    >
-      bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
+    // parks the calling worker on its node's semaphore until a waker claims it,
+    // or returns immediately if work arrived or the pool stopped while the worker went to sleep
+    inline void sleep(node_state& node)
     {
-      using result_type = result_of_t<ResultFactory()>;
+      ++num_sleeping_threads_;
+      ++node.num_sleeping_threads;
 
-      // create a shared promise to fulfill the result
-      auto shared_promise_ptr = std::make_shared<std::promise<result_type>>();
+      // a waker which queued a task before we counted ourselves asleep may not have seen us,
+      // so check again now that any later waker will
+      if(stopped_ || has_queued_tasks(node))
+      {
+        // cancel our sleep, unless a waker has already claimed us, in which case we consume its release
+        if(!try_claim_sleeper(node))
+        {
+          node.wake_up.acquire();
+        }
+      }
+      else
+      {
+        node.wake_up.acquire();
+      }
 
-      // get the shared promise's future
-      auto result_future = shared_promise_ptr->get_future();
+      --num_sleeping_threads_;
+    }
 
-      // create a deleter which fulfills the promise with the result and then deletes the result
-      fulfill_promise_and_delete<result_type> deleter{std::move(shared_promise_ptr)};
+    inline bool has_queued_tasks(const node_state& node) const
+    {
+      if(node.num_queued_tasks.load() > 0) return true;
 
-      // create the shared state for the result
-      auto shared_result_ptr = std::shared_ptr<result_type>(new result_type(result_factory()), std::move(deleter));
+      for(auto& count : num_queued_tasks_)
+      {
+        if(count.load() > 0) return true;
+      }
 
-      // create the shared state for the shared parameter
-      using shared_arg_type = result_of_t<SharedFactory()>;
-      auto shared_arg_ptr = std::make_shared<shared_arg_type>(shared_factory());
+      return false;
+    }
 
-      // share the incoming future
-      auto shared_predecessor = future_traits<Future>::share(predecessor);
+    // polls for queued tasks according to the idle policy
+    // returns true if a task was found before the worker should park
+    inline bool poll_for_work(const node_state& node) const
+    {
+      size_t num_spins = num_idle_spins_.load(std::memory_order_relaxed);
+      size_t num_polls = num_spins + num_idle_yields_.load(std::memory_order_relaxed);
 
-      // submit n tasks to the thread pool
-      for(size_t idx = 0; idx < n; ++idx)
+      for(size_t i = 0; i < num_polls; ++i)
       {
-        system_thread_pool().submit([=]() mutable
+        if(has_queued_tasks(node)) return true;
+
+        if(i < num_spins)
         {
-// nvcc makes this lambda's constructors __host__ __device__ when
-// any of its captures' constructors are __host__ __device__. This causes nvcc
-// to emit warnings about a __host__ __device__ function calling __host__ functions 
-// this #ifndef works around this problem
-#ifndef __CUDA_ARCH__
-          // wait on the predecessor future
-          shared_predecessor.wait();
-
-          // call the user's function
-          f(idx, *shared_result_ptr, *shared_arg_ptr);
-
-          // we explicitly release shared_result_ptr because even though this
-          // lambda's invocation is complete, the lambda's lifetime
-          // (and therefore shared_result_ptr's lifetime) is not necessarily complete
-          // this .reset() is what fulfills the promise via shared_result_ptr's deleter
-          shared_result_ptr.reset();
-#endif
-        });
+          spin_relax();
+        }
+        else
+        {
+          std::this_thread::yield();
+        }
       }
 
-      // return the result future
-      return std::move(result_future);
+      return false;
     }
 
-    size_t unit_shape() const
+    inline void work(size_t worker_idx)
     {
-      return system_thread_pool().size();
+      worker_context& self = this_worker();
+      self.pool = this;
+      self.index = worker_idx;
+
+      this_thread_wait_helper() = this;
+      self.rng.seed(static_cast<std::minstd_rand::result_type>(worker_idx + 1));
+
+      node_state& node = *nodes_[workers_[worker_idx]->node];
+
+      if(!node.cpus.empty())
+      {
+        // if pinning fails, the worker simply runs wherever the operating system places it
+        pin_this_thread(node.cpus);
+      }
+
+      task_type task;
+
+      while(true)
+      {
+        if(try_pop(worker_idx, self.rng, task, self.priority))
+        {
+          task();
+
+          // destroy the task's resources before looking for the next task
+          task = nullptr;
+
+          continue;
+        }
+
+        // we didn't find any work, so poll for a while before parking
+        if(poll_for_work(node))
+        {
+          continue;
+        }
+
+        // go to sleep until there is some work
+        sleep(node);
+
+        // exit only after all queued tasks have been drained
+        if(stopped_ && !has_queued_tasks(node))
+        {
+          break;
+        }
+      }
     }
+
+    std::vector<std::unique_ptr<node_state>> nodes_;
+    std::vector<std::unique_ptr<worker_state>> workers_;
+
+    // the number of tasks of each priority queued in the workers' deques and inboxes
+    // tasks queued in nodes' queues are counted by their node
+    std::atomic<size_t> num_queued_tasks_[num_task_priorities];
+    // the number of workers in sleep(), including those already claimed by a waker
+    std::atomic<size_t> num_sleeping_threads_;
+    std::atomic<size_t> next_worker_;
+
+    // the idle policy
+    std::atomic<size_t> num_idle_spins_;
+    std::atomic<size_t> num_idle_yields_;
+
+    std::atomic<bool> stopped_;
+
+    std::vector<joining_thread> threads_;
 };
 
 
-// compose thread_pool_executor with other fancy executors
-// to yield a parallel_thread_pool_executor
-using parallel_thread_pool_executor = agency::flattened_executor<
-  agency::scoped_executor<
-    thread_pool_executor,
-    agency::this_thread::parallel_executor
-  >
->;
-
-
-// compose thread_pool_executor with other fancy executors
-// to yield a parallel_vector_thread_pool_executor
-using parallel_vector_thread_pool_executor = agency::flattened_executor<
-  agency::scoped_executor<
-    thread_pool_executor,
-    agency::this_thread::vector_executor
-  >
->;
+
+// system_thread_pool_config records the size requested for the system_thread_pool() before its creation
+struct system_thread_pool_config
+{
+  std::mutex mutex;
+  size_t num_threads;
+  bool created;
+
+  static system_thread_pool_config& get()
+  {
+    static system_thread_pool_config config{{}, 0, false};
+    return config;
+  }
+};
+
+
+// requests that system_thread_pool() create num_threads threads
+// returns false, and has no effect, if system_thread_pool() has already been created
+inline bool set_system_thread_pool_size(size_t num_threads)
+{
+  system_thread_pool_config& config = system_thread_pool_config::get();
+
+  std::lock_guard<std::mutex> lock(config.mutex);
+
+  if(config.created) return false;
+
+  config.num_threads = num_threads;
+  return true;
+}
+
+
+inline thread_pool& system_thread_pool()
+{
+  static thread_pool resource([]
+  {
+    system_thread_pool_config& config = system_thread_pool_config::get();
+
+    std::lock_guard<std::mutex> lock(config.mutex);
+
+    config.created = true;
+    return config.num_threads ? config.num_threads : default_thread_pool_size();
+  }());
+
+  return resource;
+}
+
+
+// system_numa_thread_pool() is a pool whose workers are pinned to the machine's NUMA nodes
+inline thread_pool& system_numa_thread_pool()
+{
+  static thread_pool resource(numa_topology());
+  return resource;
+}
 
 
 } // end detail
@@ -0,0 +1,401 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <agency/detail/concurrency/thread_pool.hpp>
+#include <agency/detail/unique_function.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/unit.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/future.hpp>
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// thread_pool_shared_state is the shared state of a thread_pool_future
+//
+// in addition to the eventual value (or exception), the state holds a list of continuations
+// the thread which fulfills the state executes its continuations, so no thread ever needs
+// to block on the state in order to learn that it has become ready
+//
+// a state may be bound to the pool of the executor which created it, in which case
+// the tasks of thread_pool_future::then() execute on that pool
+template<class T>
+class thread_pool_shared_state
+{
+  private:
+    using value_storage_type = typename std::conditional<
+      std::is_void<T>::value,
+      unit,
+      T
+    >::type;
+
+  public:
+    explicit thread_pool_shared_state(thread_pool* pool = nullptr)
+      : ready_(0),
+        pool_(pool)
+    {}
+
+    // returns the pool to which this state is bound, or nullptr
+    thread_pool* pool() const
+    {
+      return pool_;
+    }
+
+    template<class... Args>
+    void set_value(Args&&... args)
+    {
+      fulfill([&]
+      {
+        value_.emplace(std::forward<Args>(args)...);
+      });
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+      fulfill([&]
+      {
+        exception_ = e;
+      });
+    }
+
+    // fulfills this state with the result of f(args...), or with the exception it throws
+    template<class Function, class... Args>
+    void set_result_of(Function&& f, Args&... args)
+    {
+      try
+      {
+        set_result_of_impl(std::is_void<T>(), f, args...);
+      }
+      catch(...)
+      {
+        set_exception(std::current_exception());
+      }
+    }
+
+    bool is_ready() const
+    {
+      return ready_.load(std::memory_order_acquire) != 0;
+    }
+
+    void wait()
+    {
+      if(is_ready()) return;
+
+      // a thread of a pool must not block, because the work which will fulfill this state
+      // may be queued behind it. instead, help execute the pool's queued tasks until we're ready
+      if(try_help_until([this]{ return is_ready(); }))
+      {
+        return;
+      }
+
+      atomic_wait(ready_, 0);
+    }
+
+    // the following functions require is_ready()
+
+    bool has_exception() const
+    {
+      return static_cast<bool>(exception_);
+    }
+
+    std::exception_ptr exception() const
+    {
+      return exception_;
+    }
+
+    value_storage_type& value()
+    {
+      if(exception_) std::rethrow_exception(exception_);
+
+      return *value_;
+    }
+
+    T move_value()
+    {
+      return move_value_impl(std::is_void<T>());
+    }
+
+    // registers a continuation to execute when this state becomes ready
+    // if the state is already ready, the continuation executes immediately on the calling thread
+    template<class Function>
+    void add_continuation(Function&& f)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(!is_ready())
+        {
+          continuations_.emplace_back(std::forward<Function>(f));
+          return;
+        }
+      }
+
+      std::forward<Function>(f)();
+    }
+
+  private:
+    template<class Function, class... Args>
+    void set_result_of_impl(std::false_type, Function& f, Args&... args)
+    {
+      set_value(f(args...));
+    }
+
+    template<class Function, class... Args>
+    void set_result_of_impl(std::true_type, Function& f, Args&... args)
+    {
+      f(args...);
+      set_value();
+    }
+
+    T move_value_impl(std::false_type)
+    {
+      return std::move(value());
+    }
+
+    void move_value_impl(std::true_type)
+    {
+      value();
+    }
+
+    template<class Function>
+    void fulfill(Function store)
+    {
+      std::vector<unique_function<void()>> continuations;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        store();
+        ready_.store(1, std::memory_order_release);
+
+        continuations.swap(continuations_);
+      }
+
+      atomic_notify_all(ready_);
+      notify_parked_helpers();
+
+      // execute the continuations outside of the lock
+      for(auto& continuation : continuations)
+      {
+        continuation();
+      }
+    }
+
+    std::atomic<int> ready_;
+    std::mutex mutex_;
+
+    thread_pool* pool_;
+
+    experimental::optional<value_storage_type> value_;
+    std::exception_ptr exception_;
+
+    std::vector<unique_function<void()>> continuations_;
+};
+
+
+template<class T>
+class thread_pool_future;
+
+
+template<class T>
+std::shared_ptr<thread_pool_shared_state<T>>& thread_pool_future_shared_state(thread_pool_future<T>& future);
+
+
+// thread_pool_future is the type of future returned by thread_pool_executor
+//
+// unlike std::future, a thread_pool_future may be composed with subsequent work via
+// continuations attached to its shared state. this allows work dependent on a thread_pool_future
+// to be enqueued on the thread pool when the future becomes ready, instead of
+// occupying a thread which blocks until then
+template<class T>
+class thread_pool_future
+{
+  private:
+    using state_type = thread_pool_shared_state<T>;
+
+  public:
+    thread_pool_future() = default;
+
+    thread_pool_future(thread_pool_future&&) = default;
+
+    thread_pool_future& operator=(thread_pool_future&&) = default;
+
+    explicit thread_pool_future(std::shared_ptr<state_type> state)
+      : state_(std::move(state))
+    {}
+
+    template<class... Args>
+    static thread_pool_future make_ready(Args&&... args)
+    {
+      auto state = std::make_shared<state_type>();
+      state->set_value(std::forward<Args>(args)...);
+      return thread_pool_future(std::move(state));
+    }
+
+    bool valid() const
+    {
+      return static_cast<bool>(state_);
+    }
+
+    bool is_ready() const
+    {
+      return valid() && state_->is_ready();
+    }
+
+    void wait() const
+    {
+      state_->wait();
+    }
+
+    T get()
+    {
+      wait();
+
+      // invalidate this future before returning its value
+      std::shared_ptr<state_type> state = std::move(state_);
+      return state->move_value();
+    }
+
+    // then() submits f to a thread pool when this future becomes ready
+    // the returned future becomes ready with f's result, and is bound to the same pool as this future
+    template<class Function>
+    thread_pool_future<
+      result_of_continuation_t<decay_t<Function>, thread_pool_future>
+    >
+      then(Function&& f)
+    {
+      using result_type = result_of_continuation_t<decay_t<Function>, thread_pool_future>;
+      using task_type = then_task<decay_t<Function>, result_type>;
+
+      // move our state into the task to invalidate this future
+      std::shared_ptr<state_type> state = std::move(state_);
+
+      auto result_state = std::make_shared<thread_pool_shared_state<result_type>>(state->pool());
+
+      state->add_continuation(submit_task<task_type>{task_type{std::forward<Function>(f), state, result_state}, state->pool()});
+
+      return thread_pool_future<result_type>(std::move(result_state));
+    }
+
+    // converts this future into a std::future without blocking
+    operator std::future<T>() &&
+    {
+      auto promise = std::make_shared<std::promise<T>>();
+      std::future<T> result = promise->get_future();
+
+      std::shared_ptr<state_type> state = std::move(state_);
+
+      state->add_continuation([=]
+      {
+        set_promise(*state, *promise);
+      });
+
+      return result;
+    }
+
+  private:
+    template<class Function, class Result>
+    struct then_task
+    {
+      Function f_;
+      std::shared_ptr<state_type> predecessor_;
+      std::shared_ptr<thread_pool_shared_state<Result>> result_;
+
+      void operator()()
+      {
+        if(predecessor_->has_exception())
+        {
+          result_->set_exception(predecessor_->exception());
+        }
+        else
+        {
+          invoke(std::is_void<T>());
+        }
+      }
+
+      void invoke(std::false_type)
+      {
+        result_->set_result_of(f_, predecessor_->value());
+      }
+
+      void invoke(std::true_type)
+      {
+        result_->set_result_of(f_);
+      }
+    };
+
+    // submit_task is a continuation which submits a task to the pool to which the predecessor is bound
+    // if the predecessor is not bound to a pool, the task is submitted to the pool of the thread which fulfilled
+    // the predecessor so that continuations remain on the pool which produced their predecessor. if that thread
+    // is not part of a pool either, the task is submitted to the system thread pool
+    template<class Task>
+    struct submit_task
+    {
+      Task task_;
+      thread_pool* pool_;
+
+      void operator()()
+      {
+        thread_pool* pool = pool_;
+
+        if(!pool) pool = thread_pool::current();
+        if(!pool) pool = &system_thread_pool();
+
+        pool->submit(std::move(task_));
+      }
+    };
+
+    static void set_promise(state_type& state, std::promise<T>& promise)
+    {
+      try
+      {
+        set_promise_impl(std::is_void<T>(), state, promise);
+      }
+      catch(...)
+      {
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+    static void set_promise_impl(std::false_type, state_type& state, std::promise<T>& promise)
+    {
+      promise.set_value(state.move_value());
+    }
+
+    static void set_promise_impl(std::true_type, state_type& state, std::promise<T>& promise)
+    {
+      state.move_value();
+      promise.set_value();
+    }
+
+    // friend thread_pool_future_shared_state() to give it access to state_
+    template<class U>
+    friend std::shared_ptr<thread_pool_shared_state<U>>& thread_pool_future_shared_state(thread_pool_future<U>& future);
+
+    std::shared_ptr<state_type> state_;
+};
+
+
+template<class T>
+std::shared_ptr<thread_pool_shared_state<T>>& thread_pool_future_shared_state(thread_pool_future<T>& future)
+{
+  return future.state_;
+}
+
+
+} // end detail
+} // end agency
+
@@ -110,6 +110,31 @@ class variant_barrier : private agency::experimental::variant<Barrier, Barriers.
     {
       agency::experimental::visit(arrive_and_wait_visitor{}, static_cast<super_t&>(*this));
     }
+
+  private:
+    struct arrive_and_drop_visitor
+    {
+      __agency_exec_check_disable__
+      template<class T>
+      __AGENCY_ANNOTATION
+      void operator()(T& self) const
+      {
+        self.arrive_and_drop();
+      }
+
+      __AGENCY_ANNOTATION
+      void operator()(agency::experimental::monostate) const
+      {
+        assert(0);
+      }
+    };
+
+  public:
+    __AGENCY_ANNOTATION
+    void arrive_and_drop()
+    {
+      agency::experimental::visit(arrive_and_drop_visitor{}, static_cast<super_t&>(*this));
+    }
 };
 
 
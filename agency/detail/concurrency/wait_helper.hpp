@@ -0,0 +1,123 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/atomic_wait.hpp>
+
+#include <atomic>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// a wait_helper executes other work on a thread which would otherwise block until some condition holds
+//
+// a thread_pool installs itself as the wait_helper of each of its workers, so that a worker which waits on a
+// latch or future executes the pool's queued tasks in the meantime, rather than idling while the work which
+// would satisfy the condition may be queued behind it
+class wait_helper
+{
+  public:
+    // executes other work on the calling thread until ready(ready_arg) returns true
+    virtual void help_until(bool (*ready)(const void*), const void* ready_arg) = 0;
+
+  protected:
+    ~wait_helper() = default;
+};
+
+
+// returns a reference to the calling thread's wait_helper, which is nullptr if the thread has none
+inline wait_helper*& this_thread_wait_helper()
+{
+  static thread_local wait_helper* helper = nullptr;
+  return helper;
+}
+
+
+// if the calling thread has a wait_helper, try_help_until() has it execute other work until ready() returns true, and returns true
+// otherwise, try_help_until() returns false immediately, and the caller should block until ready() instead
+template<class Predicate>
+inline bool try_help_until(const Predicate& ready)
+{
+  wait_helper* helper = this_thread_wait_helper();
+
+  if(!helper) return false;
+
+  helper->help_until([](const void* arg)
+  {
+    return (*static_cast<const Predicate*>(arg))();
+  }, &ready);
+
+  return true;
+}
+
+
+namespace wait_helper_detail
+{
+
+
+// a helper which finds no work parks on epoch until either its condition holds or new work arrives
+// count is the number of parked helpers, so that notification costs little when none are parked
+struct parked_helpers
+{
+  std::atomic<int> epoch;
+  std::atomic<int> count;
+};
+
+inline parked_helpers& parked()
+{
+  static parked_helpers result{{0}, {0}};
+  return result;
+}
+
+
+} // end wait_helper_detail
+
+
+// park_helper_until() parks the calling thread until wake() returns true
+//
+// wake() must become true only after a modification which is followed by a call to notify_parked_helpers().
+// parking may end spuriously, so the caller should check wake() again afterward
+template<class Predicate>
+inline void park_helper_until(const Predicate& wake)
+{
+  wait_helper_detail::parked_helpers& parked = wait_helper_detail::parked();
+
+  int epoch = parked.epoch.load(std::memory_order_acquire);
+
+  // register before checking wake() one last time, which pairs with the fence in notify_parked_helpers()
+  parked.count.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if(!wake())
+  {
+    atomic_wait(parked.epoch, epoch, 0, 0);
+  }
+
+  parked.count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+// wakes the threads parked in park_helper_until(), so that they check their conditions again
+// this should follow each modification which may satisfy a parked helper's condition, e.g. the release of a latch
+// or the submission of a task. it does not access the modified object, which a woken thread may destroy
+inline void notify_parked_helpers()
+{
+  wait_helper_detail::parked_helpers& parked = wait_helper_detail::parked();
+
+  // order the caller's modification before the check for parked helpers
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if(parked.count.load(std::memory_order_relaxed) > 0)
+  {
+    parked.epoch.fetch_add(1, std::memory_order_release);
+    atomic_notify_all(parked.epoch);
+  }
+}
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// work_stealing_deque is a double-ended queue of tasks owned by a single worker thread
+// the owner pushes and pops at the back of the deque, while thieves steal from the front
+//
+// each deque is guarded by its own lock, so the only contention on this lock
+// occurs between the deque's owner and the (rare) thieves which target it
+// the deque's size is mirrored in an atomic variable so that thieves may cheaply
+// skip empty victims without touching the lock
+template<class T>
+class work_stealing_deque
+{
+  public:
+    work_stealing_deque()
+      : size_(0)
+    {}
+
+    template<class... Args>
+    void emplace_back(Args&&... args)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      items_.emplace_back(std::forward<Args>(args)...);
+      size_.store(items_.size(), std::memory_order_release);
+    }
+
+    // pops from the back of the deque; called by the deque's owner
+    bool try_pop_back(T& item)
+    {
+      if(empty()) return false;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if(items_.empty()) return false;
+
+      item = std::move(items_.back());
+      items_.pop_back();
+      size_.store(items_.size(), std::memory_order_release);
+
+      return true;
+    }
+
+    // pops from the front of the deque; called by the deque's owner
+    // when it wishes to process its tasks in first-in-first-out order
+    bool try_pop_front(T& item)
+    {
+      if(empty()) return false;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if(items_.empty()) return false;
+
+      item = std::move(items_.front());
+      items_.pop_front();
+      size_.store(items_.size(), std::memory_order_release);
+
+      return true;
+    }
+
+    // steals from the front of the deque; called by threads other than the deque's owner
+    // steal() never blocks on a busy deque: if the lock is unavailable, it fails
+    // so that the thief may move on to another victim
+    bool try_steal(T& item)
+    {
+      if(empty()) return false;
+
+      std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+
+      if(!lock.owns_lock() || items_.empty()) return false;
+
+      item = std::move(items_.front());
+      items_.pop_front();
+      size_.store(items_.size(), std::memory_order_release);
+
+      return true;
+    }
+
+    bool empty() const
+    {
+      return size_.load(std::memory_order_acquire) == 0;
+    }
+
+    size_t size() const
+    {
+      return size_.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::mutex mutex_;
+    std::deque<T> items_;
+    std::atomic<size_t> size_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -6,6 +6,7 @@
 #include <agency/detail/control_structures/decay_parameter.hpp>
 #include <agency/detail/control_structures/execute_agent_functor.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
+#include <agency/detail/control_structures/reduce_result.hpp>
 #include <agency/detail/control_structures/single_result.hpp>
 #include <agency/detail/control_structures/shared_parameter.hpp>
 #include <agency/detail/control_structures/tuple_of_agent_shared_parameter_factories.hpp>
@@ -32,11 +33,16 @@ struct bulk_invoke_execution_policy_result
   >;
 
   // if the user function returns scope_result, then use scope_result_to_bulk_invoke_result to figure out what to return
+  // if the user function returns reduce_result, then the result is the type of the reduction
   // else, the result is whatever executor_result<executor_type, function_result> thinks it is
   using type = typename detail::lazy_conditional<
     is_scope_result<user_function_result>::value,
     scope_result_to_bulk_invoke_result<user_function_result, execution_policy_executor_t<ExecutionPolicy>>,
-    executor_bulk_result_or_void<execution_policy_executor_t<ExecutionPolicy>, user_function_result>
+    detail::lazy_conditional<
+      is_reduce_result<user_function_result>::value,
+      reduce_result_to_bulk_invoke_result<user_function_result, execution_policy_executor_t<ExecutionPolicy>>,
+      executor_bulk_result_or_void<execution_policy_executor_t<ExecutionPolicy>, user_function_result>
+    >
   >::type;
 };
 
@@ -45,7 +45,9 @@ template<size_t level, class Factory>
 struct decay_parameter<shared_parameter<level,Factory>>
 {
   // shared_parameters are passed to the user function by reference
-  using type = typename shared_parameter<level,Factory>::value_type &;
+  using type = typename shared_parameter_view_result<
+    typename shared_parameter<level,Factory>::value_type &
+  >::type;
 };
 
 
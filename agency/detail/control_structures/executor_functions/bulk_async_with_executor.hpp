@@ -12,6 +12,7 @@
 #include <agency/detail/control_structures/executor_functions/bulk_invoke_with_executor.hpp>
 #include <agency/detail/control_structures/executor_functions/result_factory.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
+#include <agency/detail/control_structures/reduce_result.hpp>
 #include <agency/detail/control_structures/decay_parameter.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <type_traits>
@@ -57,6 +58,26 @@ executor_future_t<E, typename detail::scope_result_container<scope,T,E>::result_
   return agency::future_cast<result_type>(exec, intermediate_future);
 }
 
+// this overload handles the special case where the user function returns a reduce_result
+// like the scope_result case, there is an intermediate future which must be converted to the result of the reduction
+template<class E, class Function, class T, class BinaryOp, class Tuple, size_t... TupleIndices>
+__AGENCY_ANNOTATION
+executor_future_t<E, typename detail::reduce_result_container<T,BinaryOp,E>::result_type>
+  bulk_async_with_executor_impl(E& exec,
+                                Function f,
+                                construct<detail::reduce_result_container<T,BinaryOp,E>, executor_shape_t<E>> result_factory,
+                                executor_shape_t<E> shape,
+                                Tuple&& shared_factory_tuple,
+                                detail::index_sequence<TupleIndices...>)
+{
+  auto intermediate_future = detail::bulk_twoway_execute_with_collected_result(exec, f, shape, result_factory, agency::get<TupleIndices>(std::forward<Tuple>(shared_factory_tuple))...);
+
+  using result_type = typename detail::reduce_result_container<T,BinaryOp,E>::result_type;
+
+  // cast the intermediate_future to result_type
+  return agency::future_cast<result_type>(exec, intermediate_future);
+}
+
 // this overload handles the special case where the user function returns void
 template<class E, class Function, class Tuple, size_t... TupleIndices>
 __AGENCY_ANNOTATION
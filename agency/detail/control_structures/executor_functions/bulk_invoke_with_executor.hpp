@@ -11,6 +11,7 @@
 #include <agency/detail/control_structures/executor_functions/unpack_shared_parameters_from_executor_and_invoke.hpp>
 #include <agency/detail/control_structures/executor_functions/result_factory.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
+#include <agency/detail/control_structures/reduce_result.hpp>
 #include <agency/detail/control_structures/decay_parameter.hpp>
 #include <agency/detail/type_traits.hpp>
 #include <type_traits>
@@ -59,11 +60,16 @@ struct bulk_invoke_with_executor_result
   >;
 
   // if the user function returns scope_result, then use scope_result_to_bulk_invoke_result to figure out what to return
+  // if the user function returns reduce_result, then the result is the type of the reduction
   // else, the result is whatever executor_bulk_result_or_void<Executor, function_result> thinks it is
   using type = typename lazy_conditional<
     is_scope_result<user_function_result>::value,
     scope_result_to_bulk_invoke_result<user_function_result, Executor>,
-    executor_bulk_result_or_void<Executor, user_function_result>
+    lazy_conditional<
+      is_reduce_result<user_function_result>::value,
+      reduce_result_to_bulk_invoke_result<user_function_result, Executor>,
+      executor_bulk_result_or_void<Executor, user_function_result>
+    >
   >::type;
 };
 
@@ -5,6 +5,7 @@
 #include <agency/execution/executor/executor_traits/executor_allocator.hpp>
 #include <agency/execution/executor/detail/utility/executor_bulk_result.hpp>
 #include <agency/detail/control_structures/scope_result.hpp>
+#include <agency/detail/control_structures/reduce_result.hpp>
 #include <type_traits>
 
 namespace agency
@@ -36,7 +37,11 @@ struct result_container
   using type = typename std::conditional<
     is_scope_result<ResultOfFunction>::value,
     typename scope_result_to_scope_result_container<ResultOfFunction, Executor>::type,
-    executor_bulk_result_t<Executor, ResultOfFunction>
+    typename std::conditional<
+      is_reduce_result<ResultOfFunction>::value,
+      typename reduce_result_to_reduce_result_container<ResultOfFunction, Executor>::type,
+      executor_bulk_result_t<Executor, ResultOfFunction>
+    >::type
   >::type;
 };
 
@@ -56,8 +56,10 @@ struct tuple_find_non_null_result;
 
 template<class... Types>
 struct tuple_find_non_null_result<tuple<Types...>>
-  : std::add_lvalue_reference<
-      typename find_exactly_one_not_null<Types...>::type
+  : shared_parameter_view_result<
+      typename std::add_lvalue_reference<
+        typename find_exactly_one_not_null<Types...>::type
+      >::type
     >
 {};
 
@@ -67,7 +69,7 @@ __AGENCY_ANNOTATION
 typename tuple_find_non_null_result<tuple<Types...>>::type
   tuple_find_non_null(const tuple<Types...>& t)
 {
-  return agency::get<find_exactly_one_not_null<Types...>::value>(t);
+  return detail::shared_parameter_view(agency::get<find_exactly_one_not_null<Types...>::value>(t));
 }
 
 
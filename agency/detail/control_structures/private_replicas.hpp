@@ -0,0 +1,193 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+// private_replicas is the object shared by the agents of a launch through share_private()
+//
+// rather than the agents sharing a single T, each thread which executes agents receives its own replica of T,
+// copied from init upon the thread's first request. the replicas occupy separate cache lines, so agents update
+// them without contention. upon destruction, which occurs when the launch completes, combine is invoked once
+// with each replica in turn
+//
+// because combine is invoked by the destructor, and executors destroy shared parameters in places from which
+// no exception could reach the caller, combine must be noexcept
+template<class T, class Combine>
+class private_replicas
+{
+  static_assert(noexcept(std::declval<Combine&>()(std::declval<T>())), "share_private(): combine must be noexcept.");
+
+  public:
+    private_replicas(const T& init, const Combine& combine)
+      : init_(init),
+        combine_(combine),
+        num_slots_(round_up_to_power_of_two(2 * available_concurrency())),
+        storage_(new char[(num_slots_ + 1) * sizeof(slot)])
+    {
+      // align the slots to cache lines
+      std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(storage_.get()) % cache_line_size;
+      slots_ = reinterpret_cast<slot*>(storage_.get() + (cache_line_size - misalignment) % cache_line_size);
+
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        ::new(&slots_[i]) slot();
+      }
+    }
+
+    // replicas are created upon request, so a private_replicas is only moved before any replicas exist
+    private_replicas(private_replicas&& other)
+      : private_replicas(other.init_, other.combine_)
+    {}
+
+    ~private_replicas()
+    {
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        if(slots_[i].is_constructed)
+        {
+          combine_(std::move(slots_[i].value()));
+          slots_[i].value().~T();
+        }
+
+        slots_[i].~slot();
+      }
+
+      for(auto& replica : overflow_replicas_)
+      {
+        combine_(std::move(*replica.second));
+      }
+    }
+
+    // calls f with each replica which has been created
+    // this must not be called concurrently with local()
+    template<class Function>
+    void for_each(Function f)
+    {
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        if(slots_[i].is_constructed)
+        {
+          f(slots_[i].value());
+        }
+      }
+
+      for(auto& replica : overflow_replicas_)
+      {
+        f(*replica.second);
+      }
+    }
+
+    // returns the calling thread's replica
+    T& local()
+    {
+      std::uintptr_t token = this_thread_token();
+
+      // probe for the calling thread's slot, claiming an empty one if the thread has none
+      size_t mask = num_slots_ - 1;
+      size_t first = (token / sizeof(void*)) * 0x9E3779B97F4A7C15ull >> 32;
+
+      for(size_t i = 0; i < num_slots_; ++i)
+      {
+        slot& s = slots_[(first + i) & mask];
+
+        std::uintptr_t owner = s.owner.load(std::memory_order_acquire);
+
+        if(owner == token)
+        {
+          return s.value();
+        }
+
+        if(owner == 0 && s.owner.compare_exchange_strong(owner, token, std::memory_order_acq_rel))
+        {
+          ::new(&s.storage) T(init_);
+          s.is_constructed = true;
+          return s.value();
+        }
+      }
+
+      // more threads than slots have requested replicas
+      return overflow_local(token);
+    }
+
+  private:
+    static constexpr size_t cache_line_size = 64;
+
+    // each slot occupies whole cache lines, so no two threads' replicas share a line
+    struct alignas(cache_line_size) slot
+    {
+      std::atomic<std::uintptr_t> owner;
+      bool is_constructed;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+      slot()
+        : owner(0),
+          is_constructed(false)
+      {}
+
+      T& value()
+      {
+        return *reinterpret_cast<T*>(&storage);
+      }
+    };
+
+    // identifies the calling thread by the address of a thread_local object
+    static std::uintptr_t this_thread_token()
+    {
+      static thread_local char token;
+      return reinterpret_cast<std::uintptr_t>(&token);
+    }
+
+    static size_t round_up_to_power_of_two(size_t n)
+    {
+      size_t result = 1;
+      while(result < n) result *= 2;
+      return result;
+    }
+
+    T& overflow_local(std::uintptr_t token)
+    {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+
+      for(auto& replica : overflow_replicas_)
+      {
+        if(replica.first == token)
+        {
+          return *replica.second;
+        }
+      }
+
+      overflow_replicas_.emplace_back(token, std::unique_ptr<T>(new T(init_)));
+      return *overflow_replicas_.back().second;
+    }
+
+    T init_;
+    Combine combine_;
+    size_t num_slots_;
+    std::unique_ptr<char[]> storage_;
+    slot* slots_;
+
+    std::mutex overflow_mutex_;
+    std::vector<std::pair<std::uintptr_t, std::unique_ptr<T>>> overflow_replicas_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/experimental/optional.hpp>
+#include <agency/detail/control_structures/private_replicas.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <utility>
+#include <tuple>
+#include <type_traits>
+
+namespace agency
+{
+
+
+// a user function returns reduce_result<T,BinaryOp> to request that bulk_invoke() return
+// the reduction of the agents' results via BinaryOp rather than a container of the results
+// BinaryOp must be default constructible, associative, and commutative
+// an agent which returns std::ignore contributes nothing to the reduction
+// when no agent contributes, the reduction is T()
+template<class T, class BinaryOp>
+class reduce_result : public experimental::optional<T>
+{
+  private:
+    using super_t = experimental::optional<T>;
+
+  public:
+    using result_type = T;
+    using binary_operation_type = BinaryOp;
+
+    __AGENCY_ANNOTATION
+    reduce_result(reduce_result&& other)
+      : super_t(std::move(other))
+    {}
+
+    __AGENCY_ANNOTATION
+    reduce_result(const T& result)
+      : super_t(result)
+    {}
+
+    __AGENCY_ANNOTATION
+    reduce_result(T&& result)
+      : super_t(std::move(result))
+    {}
+
+    __AGENCY_ANNOTATION
+    reduce_result(const decltype(std::ignore)&)
+      : super_t(experimental::nullopt)
+    {}
+};
+
+
+namespace detail
+{
+
+
+template<class T>
+struct is_reduce_result : std::false_type {};
+
+template<class T, class BinaryOp>
+struct is_reduce_result<reduce_result<T,BinaryOp>> : std::true_type {};
+
+
+// the partial reductions are folded explicitly, so nothing remains to do when they are destroyed
+struct discard_replica
+{
+  template<class T>
+  void operator()(T&&) const noexcept {}
+};
+
+
+// reduce_result_container is the intermediate result of a launch whose agents return reduce_result
+// each thread executing the agents folds its agents' results into a private partial reduction,
+// so no two threads contend. the partial reductions are folded together when the container is moved
+// by the executor upon completion, or when it is converted to the final result
+template<class T, class BinaryOp, class Executor>
+class reduce_result_container
+{
+  private:
+    using partial_type = experimental::optional<T>;
+
+  public:
+    using shape_type = executor_shape_t<Executor>;
+    using index_type = executor_index_t<Executor>;
+
+    using result_type = T;
+
+    reduce_result_container()
+      : binary_op_(),
+        partials_(partial_type(), discard_replica()),
+        result_()
+    {}
+
+    reduce_result_container(reduce_result_container&& other)
+      : binary_op_(std::move(other.binary_op_)),
+        partials_(partial_type(), discard_replica()),
+        result_(other.fold())
+    {}
+
+    reduce_result_container(const shape_type&)
+      : reduce_result_container()
+    {}
+
+    reduce_result_container& operator=(reduce_result_container&& other)
+    {
+      partials_.for_each([](partial_type& partial)
+      {
+        partial = experimental::nullopt;
+      });
+
+      binary_op_ = std::move(other.binary_op_);
+      result_ = other.fold();
+
+      return *this;
+    }
+
+    struct reference
+    {
+      reduce_result_container& self;
+
+      __agency_exec_check_disable__
+      __AGENCY_ANNOTATION
+      void operator=(reduce_result<T,BinaryOp>&& result)
+      {
+        if(result)
+        {
+          self.accumulate(self.partials_.local(), std::move(*result));
+        }
+      }
+    };
+
+    __AGENCY_ANNOTATION
+    reference operator[](const index_type&)
+    {
+      return reference{*this};
+    }
+
+    operator result_type () &&
+    {
+      partial_type result = fold();
+      return result ? std::move(*result) : result_type();
+    }
+
+  private:
+    void accumulate(partial_type& partial, T&& value)
+    {
+      if(partial)
+      {
+        *partial = binary_op_(std::move(*partial), std::move(value));
+      }
+      else
+      {
+        partial = std::move(value);
+      }
+    }
+
+    // folds the partial reductions into result_ and returns result_
+    // this must not be called concurrently with the agents
+    partial_type fold()
+    {
+      partials_.for_each([this](partial_type& partial)
+      {
+        if(partial)
+        {
+          accumulate(result_, std::move(*partial));
+          partial = experimental::nullopt;
+        }
+      });
+
+      return std::move(result_);
+    }
+
+    BinaryOp binary_op_;
+    private_replicas<partial_type, discard_replica> partials_;
+    partial_type result_;
+};
+
+
+// this maps a reduce_result<T,BinaryOp> returned by a user function
+// to the intermediate reduce_result_container type used between the execution policy
+// and executor. it is not the type returned by bulk_invoke
+template<class ReduceResult, class Executor, bool Enable = is_reduce_result<ReduceResult>::value>
+struct reduce_result_to_reduce_result_container
+{
+  using type = reduce_result_container<
+    typename ReduceResult::result_type,
+    typename ReduceResult::binary_operation_type,
+    Executor
+  >;
+};
+
+
+// when T isn't a reduce_result, it just returns some dummy type
+template<class ReduceResult, class Executor>
+struct reduce_result_to_reduce_result_container<ReduceResult,Executor,false>
+{
+  struct dummy_container
+  {
+    struct result_type {};
+  };
+
+  using type = dummy_container;
+};
+
+
+// this maps a reduce_result<T,BinaryOp> returned by a user function
+// to the type of result returned by bulk_invoke()
+template<class ReduceResult, class Executor>
+struct reduce_result_to_bulk_invoke_result
+{
+  using reduce_result_container = typename reduce_result_to_reduce_result_container<ReduceResult,Executor>::type;
+
+  using type = typename reduce_result_container::result_type;
+};
+
+
+} // end detail
+} // end agency
+
@@ -4,6 +4,7 @@
 #include <agency/tuple.hpp>
 #include <agency/detail/factory.hpp>
 #include <agency/detail/type_traits.hpp>
+#include <agency/detail/control_structures/private_replicas.hpp>
 #include <tuple>
 #include <utility>
 #include <type_traits>
@@ -51,6 +52,37 @@ struct is_shared_parameter_ref
 {};
 
 
+// an agent receives a shared parameter through a view of the object created by the executor
+// the view of most objects is the object itself
+template<class T>
+struct shared_parameter_view_result
+{
+  using type = T;
+};
+
+// the view of a private_replicas object is the calling thread's replica
+template<class T, class Combine>
+struct shared_parameter_view_result<private_replicas<T,Combine>&>
+{
+  using type = T&;
+};
+
+
+template<class T>
+__AGENCY_ANNOTATION
+T& shared_parameter_view(T& parm)
+{
+  return parm;
+}
+
+
+template<class T, class Combine>
+T& shared_parameter_view(private_replicas<T,Combine>& parm)
+{
+  return parm.local();
+}
+
+
 } // end detail
 
 
@@ -111,5 +143,23 @@ auto share(const T& val) ->
 }
 
 
+// share_private() gives each thread executing the agents a private replica of init
+// when the agents have finished, combine is called once with each replica
+// combine must be noexcept, as it is called while the launch's shared parameters are destroyed
+// this parameter kind is supported by executors which execute on the host
+template<class T, class Combine>
+auto share_private(const T& init, const Combine& combine) ->
+  decltype(
+    agency::share_at_scope_from_factory<0>(
+      detail::make_construct<detail::private_replicas<T,Combine>>(init, combine)
+    )
+  )
+{
+  return agency::share_at_scope_from_factory<0>(
+    detail::make_construct<detail::private_replicas<T,Combine>>(init, combine)
+  );
+}
+
+
 } // end agency
 
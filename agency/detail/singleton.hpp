@@ -1,7 +1,7 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
-#include <agency/cuda/detail/terminate.hpp>
+#include <agency/detail/terminate.hpp>
 
 
 namespace agency
@@ -52,7 +52,7 @@ inline T* singleton()
 
   return has_value ? &resource.value() : nullptr;
 #else
-  agency::cuda::detail::terminate_with_message("singleton(): This function is undefined in __device__ code.");
+  agency::detail::terminate_with_message("singleton(): This function is undefined in __device__ code.");
   return nullptr;
 #endif
 }
@@ -47,20 +47,29 @@ inline void throw_bad_function_call()
 template<class>
 class unique_function;
 
+// unique_function stores callables no larger than inline_capacity bytes inside of itself
+// larger callables, and callables which may throw when moved, are allocated with an allocator
 template<class Result, class... Args>
 class unique_function<Result(Args...)>
 {
   public:
     using result_type = Result;
 
+    static const std::size_t inline_capacity = 48;
+
     unique_function() = default;
 
     __AGENCY_ANNOTATION
     unique_function(std::nullptr_t)
-      : f_ptr_(nullptr)
+      : unique_function()
     {}
 
-    unique_function(unique_function&& other) = default;
+    __AGENCY_ANNOTATION
+    unique_function(unique_function&& other)
+      : unique_function()
+    {
+      move_from(other);
+    }
 
     template<class Function>
     __AGENCY_ANNOTATION
@@ -83,16 +92,35 @@ class unique_function<Result(Args...)>
     template<class Alloc>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc&, unique_function&& other)
-      : f_ptr_(std::move(other.f_ptr_))
+      : unique_function(std::move(other))
     {}
 
     template<class Alloc, class Function>
     __AGENCY_ANNOTATION
     unique_function(std::allocator_arg_t, const Alloc& alloc, Function&& f)
-      : f_ptr_(allocate_function_pointer(alloc, std::forward<Function>(f)))
-    {}
+      : unique_function()
+    {
+      using function_type = typename std::decay<Function>::type;
+      emplace(stores_inline<function_type>(), alloc, std::forward<Function>(f));
+    }
 
-    unique_function& operator=(unique_function&& other) = default;
+    __AGENCY_ANNOTATION
+    ~unique_function()
+    {
+      reset();
+    }
+
+    __AGENCY_ANNOTATION
+    unique_function& operator=(unique_function&& other)
+    {
+      if(this != &other)
+      {
+        reset();
+        move_from(other);
+      }
+
+      return *this;
+    }
 
     __AGENCY_ANNOTATION
     Result operator()(Args... args) const
@@ -102,13 +130,13 @@ class unique_function<Result(Args...)>
         unique_function_detail::throw_bad_function_call();
       }
 
-      return (*f_ptr_)(args...);
+      return invoke_(&storage_, args...);
     }
 
     __AGENCY_ANNOTATION
     operator bool () const
     {
-      return f_ptr_;
+      return invoke_ != nullptr;
     }
 
   private:
@@ -204,6 +232,107 @@ class unique_function<Result(Args...)>
       return agency::detail::allocate_unique_with_deleter<concrete_function_type>(alloc, self_deallocator_deleter(), alloc, std::forward<Function>(f));
     }
 
+    using storage_type = typename std::aligned_storage<inline_capacity>::type;
+
+    static_assert(sizeof(function_pointer) <= inline_capacity, "unique_function: function_pointer must fit in inline storage");
+
+    // callables which fit in storage_type and which will not throw when moved are stored inline
+    template<class Function>
+    using stores_inline = std::integral_constant<
+      bool,
+      sizeof(Function) <= sizeof(storage_type) &&
+      alignof(storage_type) % alignof(Function) == 0 &&
+      std::is_nothrow_move_constructible<Function>::value
+    >;
+
+    enum operation
+    {
+      move_operation,
+      destroy_operation
+    };
+
+    using invoke_function_type = Result(*)(const void*, Args...);
+    using manage_function_type = void(*)(operation, void*, void*);
+
+    __agency_exec_check_disable__
+    template<class Function>
+    __AGENCY_ANNOTATION
+    static Result invoke_inline(const void* storage, Args... args)
+    {
+      Function& f = *reinterpret_cast<Function*>(const_cast<void*>(storage));
+      return f(args...);
+    }
+
+    __AGENCY_ANNOTATION
+    static Result invoke_allocated(const void* storage, Args... args)
+    {
+      const function_pointer& f_ptr = *reinterpret_cast<const function_pointer*>(storage);
+      return (*f_ptr)(args...);
+    }
+
+    // move_operation move constructs the object at from into to and destroys the object at from
+    // destroy_operation destroys the object at from
+    __agency_exec_check_disable__
+    template<class T>
+    __AGENCY_ANNOTATION
+    static void manage(operation op, void* from, void* to)
+    {
+      T* from_ptr = reinterpret_cast<T*>(from);
+
+      if(op == move_operation)
+      {
+        ::new(to) T(std::move(*from_ptr));
+      }
+
+      from_ptr->~T();
+    }
+
+    __agency_exec_check_disable__
+    template<class Alloc, class Function>
+    __AGENCY_ANNOTATION
+    void emplace(std::true_type, const Alloc&, Function&& f)
+    {
+      using function_type = typename std::decay<Function>::type;
+
+      ::new(&storage_) function_type(std::forward<Function>(f));
+      invoke_ = &invoke_inline<function_type>;
+      manage_ = &manage<function_type>;
+    }
+
+    template<class Alloc, class Function>
+    __AGENCY_ANNOTATION
+    void emplace(std::false_type, const Alloc& alloc, Function&& f)
+    {
+      ::new(&storage_) function_pointer(allocate_function_pointer(alloc, std::forward<Function>(f)));
+      invoke_ = &invoke_allocated;
+      manage_ = &manage<function_pointer>;
+    }
+
+    __AGENCY_ANNOTATION
+    void move_from(unique_function& other)
+    {
+      if(other.manage_)
+      {
+        other.manage_(move_operation, &other.storage_, &storage_);
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
+      }
+    }
+
+    __AGENCY_ANNOTATION
+    void reset()
+    {
+      if(manage_)
+      {
+        manage_(destroy_operation, &storage_, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+      }
+    }
+
     template<class T>
     struct default_allocator
     {
@@ -240,7 +369,9 @@ class unique_function<Result(Args...)>
     };
 
 
-    function_pointer f_ptr_; 
+    mutable storage_type storage_;
+    invoke_function_type invoke_ = nullptr;
+    manage_function_type manage_ = nullptr;
 };
 
 
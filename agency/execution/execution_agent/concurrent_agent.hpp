@@ -5,6 +5,7 @@
 #include <agency/detail/concurrency/any_barrier.hpp>
 #include <agency/memory/detail/resource/arena_resource.hpp>
 #include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/scratch_resource.hpp>
 #include <agency/memory/detail/resource/tiered_resource.hpp>
 #include <agency/coordinate/point.hpp>
 #include <cstddef>
@@ -17,7 +18,11 @@ namespace detail
 
 
 using default_barrier = any_barrier;
-using default_concurrent_resource = tiered_resource<arena_resource<sizeof(int) * 128>, malloc_resource>;
+// a group's scratch_resource is empty unless its execution policy requests scratch space with .with_scratch()
+using default_concurrent_resource = tiered_resource<
+  scratch_resource,
+  tiered_resource<arena_resource<sizeof(int) * 128>, malloc_resource>
+>;
 
 
 } // end detail
@@ -6,10 +6,10 @@
 #include <agency/execution/execution_agent/detail/basic_execution_agent.hpp>
 #include <agency/detail/concurrency/barrier.hpp>
 #include <agency/detail/concurrency/in_place_barrier.hpp>
-#include <agency/container/array.hpp>
 #include <agency/experimental/optional.hpp>
 #include <agency/experimental/variant.hpp>
 #include <type_traits>
+#include <cstdint>
 
 
 namespace agency
@@ -18,7 +18,34 @@ namespace detail
 {
 
 
-template<class Index, class Barrier, class MemoryResource>
+// scratch_sized_resource constructs a MemoryResource from a number of bytes of scratch space
+// when MemoryResource accepts one, and default constructs MemoryResource otherwise
+template<class MemoryResource, bool = std::is_constructible<MemoryResource, std::size_t>::value>
+class scratch_sized_resource : public MemoryResource
+{
+  public:
+    __AGENCY_ANNOTATION
+    explicit scratch_sized_resource(std::size_t scratch_size)
+      : MemoryResource(scratch_size)
+    {}
+};
+
+template<class MemoryResource>
+class scratch_sized_resource<MemoryResource,false> : public MemoryResource
+{
+  public:
+    __AGENCY_ANNOTATION
+    explicit scratch_sized_resource(std::size_t)
+      : MemoryResource()
+    {}
+};
+
+
+// broadcasts of types no larger than BroadcastChannelSize bytes require a single barrier and no dynamic allocation
+//
+// a nonzero StaticGroupSize fixes the size of the group at compile time. collective operations then
+// keep small values in place, require one less barrier, and combine values in loops of constant length
+template<class Index, class Barrier, class MemoryResource, std::size_t BroadcastChannelSize = 4 * sizeof(void*), std::size_t StaticGroupSize = 0>
 class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarantee_t::concurrent_t, Index>
 {
   private:
@@ -28,100 +55,86 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
     // in_place_type_t with its constructor
     using barrier_type = in_place_barrier<Barrier>;
 
-    static constexpr size_t broadcast_channel_size = sizeof(void*);
-    using broadcast_channel_type = agency::array<char, broadcast_channel_size>;
+    using broadcast_channel_type = typename std::aligned_storage<BroadcastChannelSize>::type;
+    using broadcast_destructor_type = void(*)(void*);
 
-    // this function destroys *ptr if ptr is not null and then makes the entire group wait
-    // only one agent should pass a non-nullptr to this function
-    // the entire group should be convergent before calling this function
     template<class T>
     __AGENCY_ANNOTATION
-    typename std::enable_if<
-      std::is_trivially_destructible<T>::value
-    >::type
-      destroy_and_wait_if(T*)
+    static void destroy(void* ptr)
     {
-      // no op: T has a trivial destructor, so there's no need to do anything
-      // including synchronize
+      reinterpret_cast<T*>(ptr)->~T();
     }
 
-    // this function destroys *ptr if ptr is not null and then makes the entire group wait
-    // only one agent should pass a non-nullptr to this function
-    // the entire group should be convergent before calling this function
+    // returns the function which destroys a T living in a broadcast channel, or null if T's destructor is trivial
     template<class T>
     __AGENCY_ANNOTATION
-    typename std::enable_if<
-      !std::is_trivially_destructible<T>::value
-    >::type
-      destroy_and_wait_if(T* ptr)
+    static broadcast_destructor_type broadcast_destructor()
     {
-      // first destroy the object
-      if(ptr)
-      {
-        ptr->~T();
-      }
+      return std::is_trivially_destructible<T>::value ? nullptr : &destroy<T>;
+    }
 
-      // synchronize the group
-      wait();
+    // successive broadcasts alternate between the two broadcast channels. an agent writes to a channel only after
+    // it has passed the barrier of the previous broadcast, which every agent reaches only after reading from the channel
+    // two broadcasts ago. so, the channel is free to reuse, and no broadcast needs to wait for agents to finish reading
+    __AGENCY_ANNOTATION
+    size_t next_broadcast_channel()
+    {
+      size_t result = broadcast_count_ % 2;
+      ++broadcast_count_;
+      return result;
     }
 
-    
     // this overload of broadcast_impl() is for small T
     template<class T,
              __AGENCY_REQUIRES(
-               (sizeof(T) <= broadcast_channel_size)
+               (sizeof(T) <= sizeof(broadcast_channel_type)) && (alignof(T) <= alignof(broadcast_channel_type))
              )>
     __AGENCY_ANNOTATION
     T broadcast_impl(const experimental::optional<T>& value)
     {
-      // value is small enough to fit inside broadcast_channel_, so we can
+      // value is small enough to fit inside a broadcast channel, so we can
       // send it through directly without needing to dynamically allocate storage
-      
-      // reinterpret the broadcast channel into the right kind of type
-      T* shared_temporary_object = reinterpret_cast<T*>(shared_param_.broadcast_channel_.data());
+      size_t which = next_broadcast_channel();
+      void* channel = &shared_param_.broadcast_channels_[which];
 
-      // the thread with the value copies it into a shared temporary
+      // the agent with the value copies it into the channel
       if(value)
       {
-        // copy construct the shared temporary
-        ::new(shared_temporary_object) T(*value);
+        // destroy the object left behind by the channel's previous broadcast
+        shared_param_.destroy_broadcast_channel(which);
+
+        ::new(channel) T(*value);
+        shared_param_.broadcast_destructors_[which] = broadcast_destructor<T>();
       }
 
       // all agents wait for the object to be ready
       wait();
 
-      // copy the shared temporary to a local variable
-      T result = *shared_temporary_object;
-
-      // all agents wait for all other agents to finish copying the shared temporary
-      wait();
-
-      // destroy the object and all agents wait for the broadcast to become ready again
-      destroy_and_wait_if(value ? shared_temporary_object : nullptr);
-
-      return result;
+      // copy the object to a local variable
+      return *reinterpret_cast<T*>(channel);
     }
 
 
     // this overload of broadcast_impl() is for large T
     template<class T,
              __AGENCY_REQUIRES(
-               (sizeof(T) > broadcast_channel_size)
+               (sizeof(T) > sizeof(broadcast_channel_type)) || (alignof(T) > alignof(broadcast_channel_type))
              )>
     __AGENCY_ANNOTATION
     T broadcast_impl(const experimental::optional<T>& value)
     {
-      // value is too large to fit through broadcast_channel_, so
-      // we need to dynamically allocate storage
-
-      // reinterpret the broadcast channel into a pointer
-      static_assert(sizeof(broadcast_channel_type) >= sizeof(T*), "broadcast channel is too small to accomodate T*");
-      T* shared_temporary_object = reinterpret_cast<T*>(&shared_param_.broadcast_channel_);
+      // value is too large to fit through a broadcast channel, so
+      // we need to dynamically allocate storage and send a pointer to it through the channel instead
+      size_t which = next_broadcast_channel();
+      T*& shared_temporary_object = *reinterpret_cast<T**>(&shared_param_.broadcast_channels_[which]);
 
       if(value)
       {
+        // destroy the object left behind by the channel's previous broadcast
+        shared_param_.destroy_broadcast_channel(which);
+
         // dynamically allocate the shared temporary object
-        shared_temporary_object = memory_resource().allocate<alignof(T)>(sizeof(T));
+        shared_temporary_object = reinterpret_cast<T*>(memory_resource().allocate(sizeof(T)));
 
         // copy construct the shared temporary
         ::new(shared_temporary_object) T(*value);
@@ -142,17 +155,158 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         shared_temporary_object->~T();
 
         // deallocate the temporary storage
-        memory_resource().deallocate(shared_temporary_object);
+        memory_resource().deallocate(shared_temporary_object, sizeof(T));
       }
 
-      // all agents wait for the broadcast channel and memory resource to become ready again
+      return result;
+    }
+
+    static constexpr size_t cache_line_size = 64;
+
+    // returns the size of the group, which is a compile-time constant when StaticGroupSize is nonzero
+    __AGENCY_ANNOTATION
+    size_t collective_group_size() const
+    {
+      return StaticGroupSize ? StaticGroupSize : this->group_size();
+    }
+
+    // collective_slots views the values which each agent of the group contributes to a collective operation
+    // each agent's value lies in its own cache line(s)
+    template<class T>
+    struct collective_slots
+    {
+      char* base;
+      size_t stride;
+
+      __AGENCY_ANNOTATION
+      T& operator[](size_t rank) const
+      {
+        return *reinterpret_cast<T*>(base + rank * stride);
+      }
+    };
+
+    // collective_impl() gathers each agent's value into collective_slots and returns f(slots) to each agent
+    // the entire group should be convergent before calling this function
+    __agency_exec_check_disable__
+    template<class T, class Function>
+    __AGENCY_ANNOTATION
+    result_of_t<Function(const collective_slots<T>&)> collective_impl(const T& value, Function f)
+    {
+      const size_t stride = (sizeof(T) + cache_line_size - 1) / cache_line_size * cache_line_size;
+      const size_t num_bytes = collective_group_size() * stride + cache_line_size;
+
+      // groups of static size keep the slots of small values in place
+      const bool in_place = num_bytes <= sizeof(shared_param_.collective_storage_);
+
+      char* storage = shared_param_.collective_storage_;
+
+      if(!in_place)
+      {
+        // the first agent allocates the slots and sends them to the group
+        if(this->elect())
+        {
+          shared_param_.collective_slots_ = static_cast<char*>(memory_resource().allocate(num_bytes));
+        }
+
+        // all agents wait for the slots to be ready
+        wait();
+
+        storage = shared_param_.collective_slots_;
+      }
+
+      std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(storage) % cache_line_size;
+      collective_slots<T> slots{storage + (cache_line_size - misalignment) % cache_line_size, stride};
+
+      // each agent contributes its value
+      ::new(&slots[this->rank()]) T(value);
+
+      // all agents wait for every value to arrive
       wait();
 
+      auto result = f(slots);
+
+      // all agents wait for all other agents to finish reading the slots
+      wait();
+
+      if(in_place)
+      {
+        // each agent destroys its own value, so that it may not overwrite the slot
+        // in a subsequent collective operation before its value is destroyed
+        slots[this->rank()].~T();
+      }
+      else if(this->elect())
+      {
+        for(size_t i = 0; i < collective_group_size(); ++i)
+        {
+          slots[i].~T();
+        }
+
+        memory_resource().deallocate(storage, num_bytes);
+      }
+
       return result;
     }
 
+    // folds the values of the agents of rank [first, last) into init
+    __agency_exec_check_disable__
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    static T fold(const collective_slots<T>& slots, size_t first, size_t last, T init, BinaryOperation op)
+    {
+      for(size_t i = first; i < last; ++i)
+      {
+        init = op(init, slots[i]);
+      }
+
+      return init;
+    }
+
   public:
-    using param_type = typename super_t::param_type;
+    class param_type : public super_t::param_type
+    {
+      private:
+        using super_param_type = typename super_t::param_type;
+
+      public:
+        // note that the default constructor is defaulted so that execution policies may be constexpr
+        param_type() = default;
+
+        param_type(const param_type&) = default;
+
+        __AGENCY_ANNOTATION
+        param_type(const super_param_type& other)
+          : super_param_type(other),
+            scratch_size_(0)
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const typename super_t::domain_type& d)
+          : super_param_type(d),
+            scratch_size_(0)
+        {}
+
+        __AGENCY_ANNOTATION
+        param_type(const typename super_t::index_type& min, const typename super_t::index_type& max)
+          : super_param_type(min, max),
+            scratch_size_(0)
+        {}
+
+        // the number of bytes of scratch space the group's memory resource should reserve
+        __AGENCY_ANNOTATION
+        std::size_t scratch_size() const
+        {
+          return scratch_size_;
+        }
+
+        __AGENCY_ANNOTATION
+        void set_scratch_size(std::size_t n)
+        {
+          scratch_size_ = n;
+        }
+
+      private:
+        std::size_t scratch_size_ = 0;
+    };
 
     using index_type = typename super_t::index_type;
 
@@ -169,6 +323,67 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
       return broadcast_impl(value);
     }
 
+    // the following collective operations combine a value from each agent of the group in order of rank.
+    // op need only be associative. like wait(), every agent of the group must call them
+
+    // returns the combination of every agent's value to the agent of rank 0, and nothing to every other agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    experimental::optional<T> reduce(const T& value, BinaryOperation op)
+    {
+      bool elected = this->elect();
+      size_t n = collective_group_size();
+
+      return collective_impl(value, [=](const collective_slots<T>& slots) -> experimental::optional<T>
+      {
+        if(elected)
+        {
+          return fold(slots, 1, n, slots[0], op);
+        }
+
+        return experimental::nullopt;
+      });
+    }
+
+    // returns the combination of every agent's value to every agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T all_reduce(const T& value, BinaryOperation op)
+    {
+      size_t n = collective_group_size();
+
+      return collective_impl(value, [=](const collective_slots<T>& slots)
+      {
+        return fold(slots, 1, n, slots[0], op);
+      });
+    }
+
+    // returns the combination of the values of the agents of rank [0, rank()] to each agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T inclusive_scan(const T& value, BinaryOperation op)
+    {
+      size_t rank = this->rank();
+
+      return collective_impl(value, [=](const collective_slots<T>& slots)
+      {
+        return fold(slots, 1, rank + 1, slots[0], op);
+      });
+    }
+
+    // returns the combination of init and the values of the agents of rank [0, rank()) to each agent
+    template<class T, class BinaryOperation>
+    __AGENCY_ANNOTATION
+    T exclusive_scan(const T& value, const T& init, BinaryOperation op)
+    {
+      size_t rank = this->rank();
+
+      return collective_impl(value, [=](const collective_slots<T>& slots)
+      {
+        return fold(slots, 0, rank, init, op);
+      });
+    }
+
     using memory_resource_type = MemoryResource;
 
     __AGENCY_ANNOTATION
@@ -182,10 +397,13 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
       public:
         __AGENCY_ANNOTATION
         shared_param_type(const param_type& param)
-          : barrier_(param.domain().size()),
-            memory_resource_()
+          : broadcast_destructors_{nullptr, nullptr},
+            barrier_(param.domain().size()),
+            scratch_size_(param.scratch_size()),
+            memory_resource_(scratch_size_),
+            collective_slots_(nullptr)
         {
-          // note we specifically avoid default constructing broadcast_channel_
+          // note we specifically avoid default constructing broadcast_channels_
         }
 
         template<class OtherBarrier,
@@ -194,10 +412,13 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
                 )>
         __AGENCY_ANNOTATION
         shared_param_type(const param_type& param, experimental::in_place_type_t<OtherBarrier> which_barrier)
-          : barrier_(which_barrier, param.domain().size()),
-            memory_resource_()
+          : broadcast_destructors_{nullptr, nullptr},
+            barrier_(which_barrier, param.domain().size()),
+            scratch_size_(param.scratch_size()),
+            memory_resource_(scratch_size_),
+            collective_slots_(nullptr)
         {
-          // note we specifically avoid default constructing broadcast_channel_
+          // note we specifically avoid default constructing broadcast_channels_
         }
 
         // shared_param_type needs to be moveable, even if its member types aren't,
@@ -208,16 +429,41 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
         //     see wg21.link/P0135
         __AGENCY_ANNOTATION
         shared_param_type(shared_param_type&& other)
-          : barrier_(other.barrier_.index(), other.barrier_.count()),
-            memory_resource_()
+          : broadcast_destructors_{nullptr, nullptr},
+            barrier_(other.barrier_.index(), other.barrier_.count()),
+            scratch_size_(other.scratch_size_),
+            memory_resource_(scratch_size_),
+            collective_slots_(nullptr)
         {}
 
+        __AGENCY_ANNOTATION
+        ~shared_param_type()
+        {
+          destroy_broadcast_channel(0);
+          destroy_broadcast_channel(1);
+        }
+
       private:
-        // broadcast_channel_ needs to be the first member to ensure proper alignment because we reinterpret it to arbitrary T*
-        // XXX is there a more comprehensive way to ensure that this member falls on the right address?
-        broadcast_channel_type broadcast_channel_;
+        // destroys the object left in the given broadcast channel, if any
+        __AGENCY_ANNOTATION
+        void destroy_broadcast_channel(size_t which)
+        {
+          if(broadcast_destructors_[which])
+          {
+            broadcast_destructors_[which](&broadcast_channels_[which]);
+            broadcast_destructors_[which] = nullptr;
+          }
+        }
+
+        broadcast_channel_type broadcast_channels_[2];
+        broadcast_destructor_type broadcast_destructors_[2];
         barrier_type barrier_;
-        memory_resource_type memory_resource_;
+        std::size_t scratch_size_;
+        scratch_sized_resource<memory_resource_type> memory_resource_;
+        char* collective_slots_;
+
+        // in-place storage for the slots of collective operations in groups of static size
+        char collective_storage_[StaticGroupSize ? (StaticGroupSize + 1) * cache_line_size : 1];
 
         friend basic_concurrent_agent;
     };
@@ -225,11 +471,15 @@ class basic_concurrent_agent : public detail::basic_execution_agent<bulk_guarant
   private:
     shared_param_type& shared_param_;
 
+    // the number of broadcasts this agent has participated in
+    size_t broadcast_count_;
+
   protected:
     __AGENCY_ANNOTATION
     basic_concurrent_agent(const index_type& index, const param_type& param, shared_param_type& shared_param)
       : super_t(index, param),
-        shared_param_(shared_param)
+        shared_param_(shared_param),
+        broadcast_count_(0)
     {}
 
     // friend execution_agent_traits to give it access to the constructor
@@ -3,7 +3,10 @@
 #include <agency/detail/config.hpp>
 #include <agency/execution/execution_agent/experimental/detail/basic_static_execution_agent.hpp>
 #include <agency/execution/execution_agent/concurrent_agent.hpp>
+#include <agency/detail/concurrency/barrier.hpp>
 #include <agency/memory/detail/resource/arena_resource.hpp>
+#include <agency/memory/detail/resource/malloc_resource.hpp>
+#include <agency/memory/detail/resource/tiered_resource.hpp>
 #include <cstddef>
 
 namespace agency
@@ -18,13 +21,39 @@ constexpr std::size_t default_pool_size(std::size_t group_size)
   return group_size * sizeof(int);
 }
 
+namespace detail
+{
+
+
+// when compiling for the host only, static_concurrent_agent's group synchronizes with a static_barrier sized at
+// compile time, its collective operations exploit its static size, and allocations which overflow its arena
+// fall back to the heap. the shared parameters of groups which may execute on a CUDA device remain small enough
+// to live in __shared__ memory
+#ifndef __CUDACC__
+template<std::size_t group_size, std::size_t pool_size>
+using static_concurrent_agent_base = agency::detail::basic_concurrent_agent<
+  std::size_t,
+  agency::detail::static_barrier<group_size>,
+  agency::detail::tiered_resource<agency::detail::arena_resource<pool_size>, agency::detail::malloc_resource>,
+  4 * sizeof(void*),
+  group_size
+>;
+#else
+template<std::size_t group_size, std::size_t pool_size>
+using static_concurrent_agent_base = agency::detail::basic_concurrent_agent<
+  std::size_t,
+  agency::detail::default_barrier,
+  agency::detail::arena_resource<pool_size>
+>;
+#endif
+
+
+} // end detail
+
+
 template<std::size_t group_size, std::size_t grain_size = 1, std::size_t pool_size = default_pool_size(group_size)>
 using static_concurrent_agent = detail::basic_static_execution_agent<
-  agency::detail::basic_concurrent_agent<
-    std::size_t,
-    agency::detail::default_barrier,
-    agency::detail::arena_resource<pool_size>
-  >,
+  detail::static_concurrent_agent_base<group_size, pool_size>,
   group_size,
   grain_size
 >;
@@ -8,6 +8,7 @@
 #include <agency/execution/executor/concurrent_executor.hpp>
 #include <agency/execution/execution_agent.hpp>
 #include <agency/execution/execution_policy/basic_execution_policy.hpp>
+#include <cstddef>
 
 namespace agency
 {
@@ -35,6 +36,27 @@ class concurrent_execution_policy : public basic_execution_policy<concurrent_age
 
   public:
     using super_t::basic_execution_policy;
+
+    /// \brief Requests scratch space for each group of agents.
+    ///
+    ///
+    /// `with_scratch()` returns a new execution policy identical to `*this` but whose groups of agents
+    /// reserve `num_bytes` of scratch space for their memory resource. Allocations made through an agent's
+    /// `memory_resource()`, including those made by `shared<T>` objects and collective operations such as `reduce()`,
+    /// are served from this space before falling back to the heap.
+    ///
+    /// The scratch space is recycled by the thread which creates the group, so repeated launches with similar
+    /// amounts of scratch space do not allocate.
+    ///
+    /// \param num_bytes The number of bytes of scratch space to reserve for each group.
+    /// \return A copy of `*this` whose parameterization requests `num_bytes` of scratch space.
+    __AGENCY_ANNOTATION
+    concurrent_execution_policy with_scratch(std::size_t num_bytes) const
+    {
+      param_type param = this->param();
+      param.set_scratch_size(num_bytes);
+      return concurrent_execution_policy(param, this->executor());
+    }
 };
 
 
@@ -65,6 +87,27 @@ class concurrent_execution_policy_2d : public basic_execution_policy<concurrent_
 
   public:
     using super_t::basic_execution_policy;
+
+    /// \brief Requests scratch space for each group of agents.
+    ///
+    ///
+    /// `with_scratch()` returns a new execution policy identical to `*this` but whose groups of agents
+    /// reserve `num_bytes` of scratch space for their memory resource. Allocations made through an agent's
+    /// `memory_resource()`, including those made by `shared<T>` objects and collective operations such as `reduce()`,
+    /// are served from this space before falling back to the heap.
+    ///
+    /// The scratch space is recycled by the thread which creates the group, so repeated launches with similar
+    /// amounts of scratch space do not allocate.
+    ///
+    /// \param num_bytes The number of bytes of scratch space to reserve for each group.
+    /// \return A copy of `*this` whose parameterization requests `num_bytes` of scratch space.
+    __AGENCY_ANNOTATION
+    concurrent_execution_policy_2d with_scratch(std::size_t num_bytes) const
+    {
+      param_type param = this->param();
+      param.set_scratch_size(num_bytes);
+      return concurrent_execution_policy_2d(param, this->executor());
+    }
 };
 
 
@@ -7,6 +7,7 @@
 #include <agency/execution/executor/executor_array.hpp>
 #include <agency/execution/executor/flattened_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/numa_executor.hpp>
 #include <agency/execution/executor/parallel_executor.hpp>
 #include <agency/execution/executor/query.hpp>
 #include <agency/execution/executor/require.hpp>
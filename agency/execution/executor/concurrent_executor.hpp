@@ -3,14 +3,20 @@
 #include <agency/detail/config.hpp>
 #include <agency/future.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
 #include <agency/detail/invoke.hpp>
 #include <agency/detail/type_traits.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/detail/concurrency/elastic_thread_pool.hpp>
+#include <agency/detail/concurrency/latch.hpp>
 
 #include <thread>
-#include <vector>
 #include <memory>
-#include <algorithm>
 #include <utility>
+#include <atomic>
+#include <exception>
+#include <future>
 
 
 namespace agency
@@ -22,11 +28,12 @@ class concurrent_executor
   public:
     size_t unit_shape() const
     {
-      constexpr size_t default_result = 1;
-      size_t hw_concurrency = std::thread::hardware_concurrency();
+      return detail::available_concurrency();
+    }
 
-      // hardware_concurency() is allowed to return 0, so guard against a 0 result
-      return hw_concurrency ? hw_concurrency : default_result;
+    size_t query(const concurrency_t&) const
+    {
+      return detail::available_concurrency();
     }
 
     __AGENCY_ANNOTATION
@@ -41,7 +48,26 @@ class concurrent_executor
     >
     bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
     {
-      return bulk_then_execute_impl(f, n, predecessor, result_factory, shared_factory);
+      if(n > 0)
+      {
+        using result_type = detail::result_of_t<ResultFactory()>;
+        using state_type = launch_state<Function, Future, ResultFactory, SharedFactory>;
+
+        auto state_ptr = std::make_shared<state_type>(f, n, std::move(predecessor), result_factory, shared_factory);
+
+        std::future<result_type> result_future = state_ptr->promise_.get_future();
+
+        // the launching task waits for the predecessor, creates the shared parameters,
+        // and then launches the rest of the group
+        detail::system_elastic_thread_pool().submit([=]
+        {
+          state_ptr->launch();
+        });
+
+        return result_future;
+      }
+
+      return agency::detail::make_ready_future(result_factory());
     }
 
     __AGENCY_ANNOTATION
@@ -57,132 +83,144 @@ class concurrent_executor
     }
 
   private:
+    // launch_state holds the state of a single bulk_then_execute() launch
+    //
+    // a concurrent group's agents may block on each other, so each agent requires a thread of its own.
+    // rather than creating n new threads per launch, the agents execute on the threads of
+    // system_elastic_thread_pool(), which grows only when fewer than n of its threads are idle
     template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
-      bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
-                             typename std::enable_if<
-                               !std::is_void<
-                                 future_result_t<Future>
-                               >::value
-                             >::type* = 0) const
+    struct launch_state
     {
-      if(n > 0)
+      using result_type = detail::result_of_t<ResultFactory()>;
+
+      Function f_;
+      size_t n_;
+      Future predecessor_;
+      ResultFactory result_factory_;
+      SharedFactory shared_factory_;
+      std::promise<result_type> promise_;
+
+      launch_state(Function f, size_t n, Future&& predecessor, ResultFactory result_factory, SharedFactory shared_factory)
+        : f_(f),
+          n_(n),
+          predecessor_(std::move(predecessor)),
+          result_factory_(result_factory),
+          shared_factory_(shared_factory)
+      {}
+
+      // this overload of launch() is for non-void predecessors
+      template<class Future1 = Future,
+               __AGENCY_REQUIRES(!std::is_void<future_result_t<Future1>>::value)
+              >
+      void launch()
       {
-        using predecessor_type = future_result_t<Future>;
-
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=](predecessor_type& predecessor) mutable
+        try
         {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
+          auto predecessor = predecessor_.get();
 
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
-          {
-            agency::detail::invoke(f, idx, predecessor, result, shared_parameter);
-          };
-
-          size_t mid = n / 2;
-
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
-          {
-            left = this->twoway_execute(g, 0, mid);
-          }
+          // put all the shared parameters on the launching thread's stack
+          auto result = result_factory_();
 
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
           {
-            right = this->twoway_execute(g, mid + 1, n);
-          }
+            auto shared_parameter = shared_factory_();
 
-          g(mid);
+            execute_group([&](size_t idx)
+            {
+              agency::detail::invoke(f_, idx, predecessor, result, shared_parameter);
+            });
 
-          left.wait();
-          right.wait();
+            // the shared parameters are destroyed before the result becomes ready
+          }
 
-          return std::move(result);
-        });
+          promise_.set_value(std::move(result));
+        }
+        catch(...)
+        {
+          promise_.set_exception(std::current_exception());
+        }
       }
 
-      return agency::detail::make_ready_future(result_factory());
-    }
-
-    template<class Function, class Future, class ResultFactory, class SharedFactory>
-    std::future<agency::detail::result_of_t<ResultFactory()>>
-      bulk_then_execute_impl(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory,
-                             typename std::enable_if<
-                               std::is_void<
-                                 future_result_t<Future>
-                               >::value
-                             >::type* = 0) const
-    {
-      if(n > 0)
+      // this overload of launch() is for void predecessors
+      template<class Future1 = Future,
+               __AGENCY_REQUIRES(std::is_void<future_result_t<Future1>>::value)
+              >
+      void launch()
       {
-        return agency::detail::monadic_then(predecessor, std::launch::async, [=]() mutable
+        try
         {
-          // put all the shared parameters on the first thread's stack
-          auto result = result_factory();
-          auto shared_parameter = shared_factory();
+          predecessor_.get();
+
+          // put all the shared parameters on the launching thread's stack
+          auto result = result_factory_();
 
-          // create a lambda to handle parameter passing
-          auto g = [&,f](size_t idx)
           {
-            agency::detail::invoke(f, idx, result, shared_parameter);
-          };
+            auto shared_parameter = shared_factory_();
 
-          size_t mid = n / 2;
+            execute_group([&](size_t idx)
+            {
+              agency::detail::invoke(f_, idx, result, shared_parameter);
+            });
 
-          std::future<void> left = agency::detail::make_ready_future();
-          if(0 < mid)
-          {
-            left = this->twoway_execute(g, 0, mid);
+            // the shared parameters are destroyed before the result becomes ready
           }
 
-          std::future<void> right = agency::detail::make_ready_future();
-          if(mid + 1 < n)
-          {
-            right = this->twoway_execute(g, mid + 1, n);
-          }
+          promise_.set_value(std::move(result));
+        }
+        catch(...)
+        {
+          promise_.set_exception(std::current_exception());
+        }
+      }
 
-          g(mid);
+      // executes g(idx) for each idx in [0, n_) concurrently and returns when all invocations are complete
+      template<class Agent>
+      void execute_group(Agent g)
+      {
+        std::exception_ptr first_exception;
+        std::atomic_flag exception_recorded = ATOMIC_FLAG_INIT;
 
-          left.wait();
-          right.wait();
+        auto execute_agent = [&](size_t idx)
+        {
+          try
+          {
+            g(idx);
+          }
+          catch(...)
+          {
+            if(!exception_recorded.test_and_set())
+            {
+              first_exception = std::current_exception();
+            }
+          }
+        };
 
-          return std::move(result);
-        });
-      }
+        if(n_ > 1)
+        {
+          detail::latch done(n_ - 1);
 
-      return agency::detail::make_ready_future(result_factory());
-    }
+          // launch all but the first agent on the pool
+          detail::system_elastic_thread_pool().bulk_submit(n_ - 1, [&](size_t idx)
+          {
+            execute_agent(idx + 1);
+            done.count_down(1);
+          });
 
-    // first must be less than last
-    template<class Function>
-    std::future<void> twoway_execute(Function f, size_t first, size_t last) const
-    {
-      return std::async(std::launch::async, [=]() mutable
-      {
-        size_t mid = (last + first) / 2;
+          // the launching thread executes the first agent
+          execute_agent(0);
 
-        std::future<void> left = detail::make_ready_future();
-        if(first < mid)
+          done.wait();
+        }
+        else
         {
-          left = this->twoway_execute(f, first, mid);
+          execute_agent(0);
         }
 
-        std::future<void> right = detail::make_ready_future();
-        if(mid + 1 < last)
+        if(first_exception)
         {
-          right = this->twoway_execute(f, mid + 1, last);
+          std::rethrow_exception(first_exception);
         }
-
-        agency::detail::invoke(f,mid);
-
-        left.wait();
-        right.wait();
-      });
-    }
+      }
+    };
 };
 
 
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
+#include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/thread_pool.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/detail/concurrency/thread_pool_future.hpp>
+#include <agency/detail/concurrency/elastic_thread_pool.hpp>
+#include <agency/execution/executor/detail/this_thread_parallel_executor.hpp>
+#include <agency/execution/executor/vector_executor.hpp>
+#include <agency/execution/executor/scoped_executor.hpp>
+#include <agency/execution/executor/flattened_executor.hpp>
+#include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
+#include <agency/future.hpp>
+#include <agency/future/always_ready_future.hpp>
+#include <agency/experimental/optional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+
+namespace agency
+{
+namespace detail
+{
+
+
+class thread_pool_executor
+{
+  public:
+    template<class T>
+    using future = thread_pool_future<T>;
+
+    constexpr static bulk_guarantee_t::parallel_t query(bulk_guarantee_t)
+    {
+      return bulk_guarantee.parallel;
+    }
+
+    // any_node indicates that a thread_pool_executor's agents may execute on any of its pool's nodes
+    static constexpr size_t any_node = static_cast<size_t>(-1);
+
+    thread_pool_executor()
+      : thread_pool_executor(system_thread_pool())
+    {}
+
+    // creates a thread_pool_executor whose agents execute on the given node of pool
+    // node must be any_node or lie within [0, pool.num_nodes()), otherwise std::out_of_range is thrown
+    explicit thread_pool_executor(thread_pool& pool, size_t node = any_node)
+      : pool_(&pool),
+        node_(node),
+        priority_(task_priority::normal)
+    {
+      if(node != any_node && node >= pool.num_nodes())
+      {
+        throw std::out_of_range("thread_pool_executor: node is not a node of pool.");
+      }
+    }
+
+    thread_pool& pool() const
+    {
+      return *pool_;
+    }
+
+    size_t node() const
+    {
+      return node_;
+    }
+
+    // returns a copy of this executor whose tasks are submitted to the pool with the given priority
+    thread_pool_executor require(const priority_t& prop) const
+    {
+      thread_pool_executor result = *this;
+
+      // priority_t's levels are ordered in the same way as task_priority's
+      result.priority_ = static_cast<task_priority>(prop.level());
+      return result;
+    }
+
+    priority_t::level_type query(const priority_t&) const
+    {
+      return static_cast<priority_t::level_type>(priority_);
+    }
+
+    // returns a copy of this executor which submits no more agents once a stop is requested through prop's token
+    thread_pool_executor require(const stoppable_t& prop) const
+    {
+      thread_pool_executor result = *this;
+      result.stop_token_ = prop.token();
+      return result;
+    }
+
+    stop_token query(const stoppable_t&) const
+    {
+      return stop_token_;
+    }
+
+    friend bool operator==(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
+    {
+      return a.pool_ == b.pool_ && a.node_ == b.node_ && a.priority_ == b.priority_ && a.stop_token_ == b.stop_token_;
+    }
+
+    friend bool operator!=(const thread_pool_executor& a, const thread_pool_executor& b) noexcept
+    {
+      return !(a == b);
+    }
+
+  private:
+    // bulk_state holds everything a bulk_then_execute() launch needs in a single allocation
+    //
+    // rather than submitting one task per agent, bulk_then_execute() submits at most one task per
+    // pool thread. these tasks cooperatively execute the agents by dispensing contiguous ranges of
+    // agent indices from the shared next_index_ counter. so, neither the number of submissions nor
+    // the number of allocations grows with the number of agents.
+    //
+    // the tasks are not submitted until the predecessor's state becomes ready, so no thread of the pool
+    // ever blocks waiting on the predecessor. once a stop is requested through stop_token_, the tasks
+    // dispense no more ranges and the remaining agents are skipped. the task which finishes last fulfills the result's state.
+    // it destroys the shared argument beforehand, so any effects of its destruction (e.g., the merge
+    // of share_private()'s replicas) are visible once the result is ready
+    template<class Function, class Predecessor, class Result, class SharedArg>
+    struct bulk_state
+    {
+      Function f_;
+      thread_pool* pool_;
+      size_t node_;
+      task_priority priority_;
+      stop_token stop_token_;
+      size_t n_;
+      size_t num_tasks_;
+      size_t grain_size_;
+      std::shared_ptr<thread_pool_shared_state<Predecessor>> predecessor_;
+      std::shared_ptr<thread_pool_shared_state<Result>> result_state_;
+      Result result_;
+      experimental::optional<SharedArg> shared_arg_;
+      std::atomic<size_t> next_index_;
+      std::atomic<size_t> num_unfinished_tasks_;
+
+      bulk_state(Function f, thread_pool* pool, size_t node, task_priority priority, const stop_token& stop, size_t n, size_t num_tasks, std::shared_ptr<thread_pool_shared_state<Predecessor>> predecessor, Result&& result, SharedArg&& shared_arg)
+        : f_(f),
+          pool_(pool),
+          node_(node),
+          priority_(priority),
+          stop_token_(stop),
+          n_(n),
+          num_tasks_(num_tasks),
+          // give each task several ranges to balance the load among the tasks
+          grain_size_(std::max<size_t>(1, n / (4 * std::max<size_t>(1, num_tasks)))),
+          predecessor_(std::move(predecessor)),
+          result_state_(std::make_shared<thread_pool_shared_state<Result>>(pool)),
+          result_(std::move(result)),
+          shared_arg_(experimental::in_place, std::move(shared_arg)),
+          next_index_(0),
+          num_unfinished_tasks_(num_tasks)
+      {}
+
+      // launch() submits the tasks once the predecessor is ready
+      static void launch(const std::shared_ptr<bulk_state>& self)
+      {
+        if(self->predecessor_->has_exception())
+        {
+          // forward the predecessor's exception to the result without executing any agents
+          self->shared_arg_.reset();
+          self->result_state_->set_exception(self->predecessor_->exception());
+        }
+        else if(self->num_tasks_ == 0 || self->stop_token_.stop_requested())
+        {
+          // there are no agents to execute, so the result is ready immediately
+          self->shared_arg_.reset();
+          self->result_state_->set_value(std::move(self->result_));
+        }
+        else
+        {
+          for(size_t i = 0; i < self->num_tasks_; ++i)
+          {
+            auto task = [=]
+            {
+// nvcc makes this lambda's constructors __host__ __device__ when
+// any of its captures' constructors are __host__ __device__. This causes nvcc
+// to emit warnings about a __host__ __device__ function calling __host__ functions
+// this #ifndef works around this problem
+#ifndef __CUDA_ARCH__
+              self->run();
+#endif
+            };
+
+            if(self->node_ == any_node)
+            {
+              self->pool_->submit(self->priority_, std::move(task));
+            }
+            else
+            {
+              // keep the agents on the requested node
+              self->pool_->submit(self->node_, self->priority_, std::move(task));
+            }
+          }
+        }
+      }
+
+      template<class... PredecessorArg>
+      void execute_agents(PredecessorArg&... predecessor_arg)
+      {
+        size_t first = 0;
+        while(!stop_token_.stop_requested() && (first = next_index_.fetch_add(grain_size_, std::memory_order_relaxed)) < n_)
+        {
+          size_t last = std::min(n_, first + grain_size_);
+
+          for(size_t idx = first; idx < last; ++idx)
+          {
+            f_(idx, predecessor_arg..., result_, *shared_arg_);
+          }
+        }
+      }
+
+      // this overload of run() is for non-void predecessors
+      template<class Predecessor1 = Predecessor,
+               __AGENCY_REQUIRES(!std::is_void<Predecessor1>::value)
+              >
+      void run()
+      {
+        execute_agents(predecessor_->value());
+
+        finish();
+      }
+
+      // this overload of run() is for void predecessors
+      template<class Predecessor1 = Predecessor,
+               __AGENCY_REQUIRES(std::is_void<Predecessor1>::value)
+              >
+      void run()
+      {
+        execute_agents();
+
+        finish();
+      }
+
+      void finish()
+      {
+        // the last task to finish fulfills the result
+        if(num_unfinished_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+          shared_arg_.reset();
+          result_state_->set_value(std::move(result_));
+        }
+      }
+    };
+
+    // foreign_future_waiter adapts a future of some other type into a thread_pool_shared_state
+    template<class Future>
+    struct foreign_future_waiter
+    {
+      Future future_;
+      std::shared_ptr<thread_pool_shared_state<future_result_t<Future>>> state_;
+
+      void operator()()
+      {
+        state_->set_result_of([this]
+        {
+          return future_.get();
+        });
+      }
+    };
+
+    // a thread_pool_future's state may be shared directly
+    template<class T>
+    std::shared_ptr<thread_pool_shared_state<T>> predecessor_state(thread_pool_future<T>& predecessor) const
+    {
+      return std::move(thread_pool_future_shared_state(predecessor));
+    }
+
+    // other types of futures are waited on by a thread outside of the thread pool
+    template<class Future>
+    std::shared_ptr<thread_pool_shared_state<future_result_t<Future>>> predecessor_state(Future& predecessor) const
+    {
+      auto state = std::make_shared<thread_pool_shared_state<future_result_t<Future>>>(pool_);
+
+      foreign_future_waiter<Future> waiter{std::move(predecessor), state};
+
+      if(is_ready(waiter.future_))
+      {
+        // the predecessor is ready, so there's no need to wait
+        waiter();
+      }
+      else
+      {
+        // wait on the elastic thread pool so that none of the thread pool's threads block
+        system_elastic_thread_pool().submit(std::move(waiter));
+      }
+
+      return state;
+    }
+
+    template<class Future>
+    static bool is_ready(Future&)
+    {
+      // we don't know how to query an arbitrary future
+      return false;
+    }
+
+    template<class T>
+    static bool is_ready(std::future<T>& future)
+    {
+      return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    template<class T>
+    static bool is_ready(std::shared_future<T>& future)
+    {
+      return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    template<class T>
+    static bool is_ready(always_ready_future<T>&)
+    {
+      return true;
+    }
+
+  public:
+    // the returned future is bound to this executor's pool, so the continuations of its then() execute there
+    template<class T, class... Args>
+    future<T> make_ready_future(Args&&... args) const
+    {
+      auto state = std::make_shared<thread_pool_shared_state<T>>(pool_);
+      state->set_value(std::forward<Args>(args)...);
+      return future<T>(std::move(state));
+    }
+
+    template<class Function, class Future, class ResultFactory, class SharedFactory>
+    future<
+      result_of_t<ResultFactory()>
+    >
+      bulk_then_execute(Function f, size_t n, Future& predecessor, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      using predecessor_type = future_result_t<Future>;
+      using result_type = result_of_t<ResultFactory()>;
+      using shared_arg_type = result_of_t<SharedFactory()>;
+      using state_type = bulk_state<Function, predecessor_type, result_type, shared_arg_type>;
+
+      // there's no need for more tasks than there are threads to execute them
+      size_t num_tasks = std::min(n, unit_shape());
+
+      // create the shared state for the launch
+      auto state_ptr = std::make_shared<state_type>(f, pool_, node_, priority_, stop_token_, n, num_tasks, predecessor_state(predecessor), result_factory(), shared_factory());
+
+      future<result_type> result_future(state_ptr->result_state_);
+
+      // launch the tasks when the predecessor becomes ready
+      state_ptr->predecessor_->add_continuation([=]
+      {
+        state_type::launch(state_ptr);
+      });
+
+      return result_future;
+    }
+
+    size_t unit_shape() const
+    {
+      return node_ == any_node ? pool_->size() : pool_->node_size(node_);
+    }
+
+    // a pool may have more threads than the process has processors, so limit the result by the available concurrency
+    size_t query(const concurrency_t&) const
+    {
+      return std::min(unit_shape(), available_concurrency());
+    }
+
+  private:
+    thread_pool* pool_;
+    size_t node_;
+    task_priority priority_;
+    stop_token stop_token_;
+};
+
+
+// compose thread_pool_executor with other fancy executors
+// to yield a parallel_thread_pool_executor
+// each of the pool's tasks executes a chunk of agents sequentially, so the chunks check for a stop as well
+using parallel_thread_pool_executor = agency::flattened_executor<
+  agency::scoped_executor<
+    thread_pool_executor,
+    stoppable_sequenced_executor
+  >
+>;
+
+
+// compose thread_pool_executor with other fancy executors
+// to yield a parallel_vector_thread_pool_executor
+using parallel_vector_thread_pool_executor = agency::flattened_executor<
+  agency::scoped_executor<
+    thread_pool_executor,
+    agency::this_thread::vector_executor
+  >
+>;
+
+
+} // end detail
+} // end agency
+
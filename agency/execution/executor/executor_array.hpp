@@ -70,6 +70,13 @@ class executor_array
       : inner_executors_(n, exec)
     {}
 
+    __agency_exec_check_disable__
+    __AGENCY_ANNOTATION
+    executor_array(const outer_executor_type& outer_exec, size_t n, const inner_executor_type& exec = inner_executor_type())
+      : outer_executor_(outer_exec),
+        inner_executors_(n, exec)
+    {}
+
     template<class Iterator>
     executor_array(Iterator executors_begin, Iterator executors_end)
       : inner_executors_(executors_begin, executors_end)
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <agency/detail/concurrency/thread_pool.hpp>
+#include <agency/execution/executor/detail/thread_pool_executor.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+namespace agency
+{
+
+
+// numa_executor is a parallel_executor whose agents execute on a single NUMA node of the machine
+//
+// its agents execute on the workers of system_numa_thread_pool() which are pinned to the given node,
+// so the agents of a bulk launch never leave the node's processors. this keeps streaming kernels
+// close to memory allocated on the node
+//
+// nodes are named by the operating system's identifiers. only the nodes with processors available
+// to this process, as listed by node_ids(), may execute agents
+class numa_executor : public detail::parallel_thread_pool_executor
+{
+  private:
+    using super_t = detail::parallel_thread_pool_executor;
+    using outer_executor_type = detail::thread_pool_executor;
+    using inner_executor_type = detail::stoppable_sequenced_executor;
+
+  public:
+    // creates a numa_executor whose agents execute on the first of node_ids()
+    numa_executor()
+      : numa_executor(outer_executor_type(detail::system_numa_thread_pool(), 0))
+    {}
+
+    // creates a numa_executor whose agents execute on the node whose operating system identifier is node_id
+    // node_id must be one of node_ids(), otherwise std::out_of_range is thrown
+    explicit numa_executor(size_t node_id)
+      : numa_executor(outer_executor_type(detail::system_numa_thread_pool(), find_node(node_id)))
+    {}
+
+    // returns the operating system's identifier for the node on which this executor's agents execute
+    size_t node() const
+    {
+      return detail::system_numa_thread_pool().node_id(base_executor().outer_executor().node());
+    }
+
+    // returns the number of NUMA nodes available to numa_executors
+    static size_t num_nodes()
+    {
+      return detail::system_numa_thread_pool().num_nodes();
+    }
+
+    // returns the operating system's identifiers for the NUMA nodes available to numa_executors
+    static std::vector<size_t> node_ids()
+    {
+      detail::thread_pool& pool = detail::system_numa_thread_pool();
+
+      std::vector<size_t> result(pool.num_nodes());
+      for(size_t node = 0; node < result.size(); ++node)
+      {
+        result[node] = pool.node_id(node);
+      }
+
+      return result;
+    }
+
+    // inherit bulk_guarantee queries
+    using super_t::query;
+
+    size_t query(const concurrency_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+    // returns a copy of this executor whose agents begin executing before queued work of lower priority on its node
+    numa_executor require(const priority_t& prop) const
+    {
+      return numa_executor(base_executor().outer_executor().require(prop));
+    }
+
+    priority_t::level_type query(const priority_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+    // returns a copy of this executor which begins no more agents once a stop is requested through prop's token
+    numa_executor require(const stoppable_t& prop) const
+    {
+      return numa_executor(base_executor().outer_executor().require(prop), base_executor().inner_executor(0).require(prop));
+    }
+
+    stop_token query(const stoppable_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+  private:
+    static size_t find_node(size_t node_id)
+    {
+      size_t result = detail::system_numa_thread_pool().find_node(node_id);
+
+      if(result == num_nodes())
+      {
+        throw std::out_of_range("numa_executor: node_id is not one of node_ids().");
+      }
+
+      return result;
+    }
+
+    explicit numa_executor(const outer_executor_type& outer_executor, const inner_executor_type& inner_executor = inner_executor_type())
+      : super_t(scoped_executor<outer_executor_type, inner_executor_type>(outer_executor, inner_executor))
+    {}
+};
+
+
+} // end agency
+
@@ -2,13 +2,159 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/concurrency/thread_pool.hpp>
-#include <agency/execution/executor/detail/this_thread_parallel_executor.hpp>
+#include <agency/execution/executor/detail/thread_pool_executor.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
+
+#include <memory>
 
 namespace agency
 {
 
 
-using parallel_executor = detail::parallel_thread_pool_executor;
+// thread_pool is a pool of threads which may execute the agents of parallel_executors
+//
+// by default, parallel_executors execute on a pool created upon first use with one thread per hardware thread,
+// or with the number of threads given by the AGENCY_NUM_THREADS environment variable.
+// separately constructed pools allow different kinds of work, e.g. latency-critical and batch work,
+// to execute on disjoint sets of threads
+//
+// work is submitted to a pool only through the parallel_executors bound to it
+class thread_pool
+{
+  public:
+    // idle_policy describes how an idle thread of the pool waits for work
+    // the thread polls for work num_spins times in a busy loop and then num_yields times, yielding its
+    // processor between polls, before it parks until new work is submitted
+    using idle_policy = detail::thread_pool::idle_policy;
+
+    explicit thread_pool(size_t num_threads = detail::default_thread_pool_size(), idle_policy policy = idle_policy())
+      : owned_impl_(new detail::thread_pool(num_threads, policy)),
+        impl_(owned_impl_.get())
+    {}
+
+    thread_pool(const thread_pool&) = delete;
+
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // returns the number of threads owned by this pool
+    size_t size() const
+    {
+      return impl_->size();
+    }
+
+    idle_policy get_idle_policy() const
+    {
+      return impl_->get_idle_policy();
+    }
+
+    // threads which are already idle adopt the new policy the next time they find no work
+    void set_idle_policy(const idle_policy& policy)
+    {
+      impl_->set_idle_policy(policy);
+    }
+
+    // returns true if the calling thread is one of this pool's threads
+    bool is_worker_thread() const
+    {
+      return impl_->is_worker_thread();
+    }
+
+  private:
+    // wraps a pool owned by someone else
+    explicit thread_pool(detail::thread_pool& impl)
+      : impl_(&impl)
+    {}
+
+    friend thread_pool& default_thread_pool();
+    friend class parallel_executor;
+
+    std::unique_ptr<detail::thread_pool> owned_impl_;
+    detail::thread_pool* impl_;
+};
+
+
+// returns the pool on which default-constructed parallel_executors execute
+inline thread_pool& default_thread_pool()
+{
+  static thread_pool result(detail::system_thread_pool());
+  return result;
+}
+
+
+// requests that the default thread pool create num_threads threads
+// returns false, and has no effect, if the default thread pool is already in use
+inline bool set_default_thread_pool_size(size_t num_threads)
+{
+  return detail::set_system_thread_pool_size(num_threads);
+}
+
+
+class parallel_executor : public detail::parallel_thread_pool_executor
+{
+  private:
+    using super_t = detail::parallel_thread_pool_executor;
+    using outer_executor_type = detail::thread_pool_executor;
+    using inner_executor_type = detail::stoppable_sequenced_executor;
+
+  public:
+    // creates a parallel_executor which executes its agents on the default thread pool
+    parallel_executor()
+      : parallel_executor(default_thread_pool())
+    {}
+
+    // creates a parallel_executor which executes its agents on the given pool
+    // the pool must outlive the parallel_executor and any work created through it
+    explicit parallel_executor(thread_pool& pool)
+      : parallel_executor(pool, outer_executor_type(*pool.impl_))
+    {}
+
+    // returns the pool on which this executor's agents execute
+    thread_pool& pool() const
+    {
+      return *pool_;
+    }
+
+    // inherit bulk_guarantee queries
+    using super_t::query;
+
+    size_t query(const concurrency_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+    // returns a copy of this executor whose agents begin executing before queued work of lower priority
+    parallel_executor require(const priority_t& prop) const
+    {
+      return parallel_executor(*pool_, base_executor().outer_executor().require(prop));
+    }
+
+    priority_t::level_type query(const priority_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+    // returns a copy of this executor which begins no more agents once a stop is requested through prop's token
+    // the pool's tasks stop claiming chunks of agents, and each task stops executing its current chunk
+    parallel_executor require(const stoppable_t& prop) const
+    {
+      return parallel_executor(*pool_, base_executor().outer_executor().require(prop), base_executor().inner_executor(0).require(prop));
+    }
+
+    stop_token query(const stoppable_t& prop) const
+    {
+      return base_executor().outer_executor().query(prop);
+    }
+
+  private:
+    parallel_executor(thread_pool& pool, const outer_executor_type& outer_executor, const inner_executor_type& inner_executor = inner_executor_type())
+      : super_t(scoped_executor<outer_executor_type, inner_executor_type>(outer_executor, inner_executor)),
+        pool_(&pool)
+    {}
+
+    thread_pool* pool_;
+};
 
 
 } // end agency
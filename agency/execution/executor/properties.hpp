@@ -29,7 +29,10 @@
 #include <agency/execution/executor/properties/always_blocking.hpp>
 #include <agency/execution/executor/properties/bulk.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
 #include <agency/execution/executor/properties/single.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
 #include <agency/execution/executor/properties/then.hpp>
 #include <agency/execution/executor/properties/twoway.hpp>
 
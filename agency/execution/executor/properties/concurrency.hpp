@@ -0,0 +1,62 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <cstddef>
+
+
+namespace agency
+{
+
+
+// concurrency_t is a query-only property whose value is the number of an executor's execution agents
+// which the hardware available to the executor is able to execute simultaneously
+//
+// for executors which execute on the host, this value respects the affinity mask and the
+// cgroup CPU quota of the process, so it is meaningful inside of containers
+struct concurrency_t
+{
+  constexpr static bool is_requirable = false;
+  constexpr static bool is_preferable = false;
+
+  using polymorphic_query_result_type = std::size_t;
+};
+
+
+// define the property object
+
+#ifndef __CUDA_ARCH__
+constexpr concurrency_t concurrency{};
+#else
+// CUDA __device__ functions cannot access global variables so make concurrency a __device__ variable in __device__ code
+const __device__ concurrency_t concurrency;
+#endif
+
+
+} // end agency
+
@@ -0,0 +1,93 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+
+
+namespace agency
+{
+
+
+// priority_t is a property which orders the work of an executor relative to its other work
+//
+// an executor which satisfies priority(priority_t::high) begins its work before any queued work of lower priority
+// which was created through executors sharing its execution resources. the default priority is priority_t::normal
+//
+// usage:
+//
+//   auto urgent = agency::require(exec, agency::priority(agency::priority_t::high));
+//   assert(agency::query(urgent, agency::priority) == agency::priority_t::high);
+struct priority_t
+{
+  constexpr static bool is_requirable = true;
+  constexpr static bool is_preferable = true;
+
+  enum level_type
+  {
+    low,
+    normal,
+    high
+  };
+
+  using polymorphic_query_result_type = level_type;
+
+  __AGENCY_ANNOTATION
+  constexpr priority_t(level_type level = normal)
+    : level_(level)
+  {}
+
+  // returns a priority_t requesting the given level
+  __AGENCY_ANNOTATION
+  constexpr priority_t operator()(level_type level) const
+  {
+    return priority_t(level);
+  }
+
+  __AGENCY_ANNOTATION
+  constexpr level_type level() const
+  {
+    return level_;
+  }
+
+  private:
+    level_type level_;
+};
+
+
+// define the property object
+
+#ifndef __CUDA_ARCH__
+constexpr priority_t priority{};
+#else
+// CUDA __device__ functions cannot access global variables so make priority a __device__ variable in __device__ code
+const __device__ priority_t priority;
+#endif
+
+
+} // end agency
+
@@ -0,0 +1,187 @@
+// Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <atomic>
+#include <memory>
+
+
+namespace agency
+{
+
+
+class stop_token;
+
+
+namespace detail
+{
+
+
+inline const std::atomic<bool>* stop_token_flag(const stop_token& token);
+
+
+} // end detail
+
+
+// stop_token observes whether a stop has been requested through its associated stop_source
+// a default-constructed stop_token has no associated stop_source, and no stop may be requested through it
+class stop_token
+{
+  public:
+    stop_token() = default;
+
+    bool stop_possible() const
+    {
+      return static_cast<bool>(flag_);
+    }
+
+    bool stop_requested() const
+    {
+      return flag_ && flag_->load(std::memory_order_relaxed);
+    }
+
+    friend bool operator==(const stop_token& a, const stop_token& b)
+    {
+      return a.flag_ == b.flag_;
+    }
+
+    friend bool operator!=(const stop_token& a, const stop_token& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    friend class stop_source;
+    friend const std::atomic<bool>* detail::stop_token_flag(const stop_token&);
+
+    explicit stop_token(const std::shared_ptr<std::atomic<bool>>& flag)
+      : flag_(flag)
+    {}
+
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+
+// stop_source requests a stop which is observed by its stop_tokens
+// copies of a stop_source share a single stop state, so request_stop() may be called through a copy captured by a function
+class stop_source
+{
+  public:
+    stop_source()
+      : flag_(std::make_shared<std::atomic<bool>>(false))
+    {}
+
+    // returns true if this call requested the stop
+    bool request_stop() const
+    {
+      return !flag_->exchange(true, std::memory_order_relaxed);
+    }
+
+    bool stop_requested() const
+    {
+      return flag_->load(std::memory_order_relaxed);
+    }
+
+    stop_token get_token() const
+    {
+      return stop_token(flag_);
+    }
+
+  private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+
+namespace detail
+{
+
+
+// returns a pointer to token's stop flag, or nullptr if token has no associated stop_source
+// the pointer is valid while some stop_token or stop_source associated with the flag exists
+inline const std::atomic<bool>* stop_token_flag(const stop_token& token)
+{
+  return token.flag_.get();
+}
+
+
+} // end detail
+
+
+// stoppable_t is a property which associates an executor with a stop_token
+//
+// once a stop is requested, an executor which satisfies stoppable(token) does not begin the execution
+// of any more of its agents. agents already executing run to completion, and the results of the agents
+// which never executed remain default-constructed. so, the agents of a parallel search may end
+// their launch early:
+//
+//   agency::stop_source stop;
+//   auto exec = agency::require(agency::parallel_executor(), agency::stoppable(stop.get_token()));
+//
+//   agency::bulk_invoke(agency::par(n).on(exec), [=](agency::parallel_agent& self)
+//   {
+//     if(is_answer(self.index())) stop.request_stop();
+//   });
+//
+// executors check for a stop between chunks of agents, so an agent which begins after a stop has been
+// requested is possible, but rare
+struct stoppable_t
+{
+  constexpr static bool is_requirable = true;
+  constexpr static bool is_preferable = true;
+
+  using polymorphic_query_result_type = stop_token;
+
+  stoppable_t() = default;
+
+  explicit stoppable_t(const stop_token& token)
+    : token_(token)
+  {}
+
+  // returns a stoppable_t requesting the given token
+  stoppable_t operator()(const stop_token& token) const
+  {
+    return stoppable_t(token);
+  }
+
+  const stop_token& token() const
+  {
+    return token_;
+  }
+
+  private:
+    stop_token token_;
+};
+
+
+// define the property object
+
+const stoppable_t stoppable{};
+
+
+} // end agency
+
@@ -28,6 +28,7 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/requires.hpp>
+#include <agency/detail/static_const.hpp>
 #include <agency/execution/executor/executor_traits/detail/has_static_query.hpp>
 #include <agency/execution/executor/executor_traits/detail/has_query_member.hpp>
 #include <agency/execution/executor/executor_traits/detail/has_query_free_function.hpp>
@@ -3,11 +3,20 @@
 #include <agency/future/always_ready_future.hpp>
 #include <agency/execution/executor/properties/always_blocking.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
 #include <functional>
 #include <utility>
 
 namespace agency
 {
+namespace detail
+{
+
+
+class stoppable_sequenced_executor;
+
+
+} // end detail
 
 
 class sequenced_executor
@@ -48,6 +57,10 @@ class sequenced_executor
       return agency::make_always_ready_future(std::move(result));
     }
 
+    // returns a sequenced executor which executes no more agents once a stop is requested through prop's token
+    // sequenced_executor is a literal type, so the result is an executor of a different type which owns the token
+    detail::stoppable_sequenced_executor require(const stoppable_t& prop) const;
+
     __AGENCY_ANNOTATION
     friend constexpr bool operator==(const sequenced_executor&, const sequenced_executor&) noexcept
     {
@@ -62,5 +75,80 @@ class sequenced_executor
 };
 
 
+namespace detail
+{
+
+
+// stoppable_sequenced_executor is a sequenced_executor which checks a stop_token before executing each agent
+class stoppable_sequenced_executor : public sequenced_executor
+{
+  public:
+    stoppable_sequenced_executor() = default;
+
+    explicit stoppable_sequenced_executor(const stop_token& token)
+      : stop_token_(token)
+    {}
+
+    using sequenced_executor::query;
+
+    stop_token query(const stoppable_t&) const
+    {
+      return stop_token_;
+    }
+
+    stoppable_sequenced_executor require(const stoppable_t& prop) const
+    {
+      return stoppable_sequenced_executor(prop.token());
+    }
+
+    template<class Function, class ResultFactory, class SharedFactory>
+    always_ready_future<agency::detail::result_of_t<ResultFactory()>>
+      bulk_twoway_execute(Function f, size_t n, ResultFactory result_factory, SharedFactory shared_factory) const
+    {
+      auto result = result_factory();
+      auto shared_parm = shared_factory();
+
+      if(stop_token_.stop_possible())
+      {
+        for(size_t i = 0; i < n && !stop_token_.stop_requested(); ++i)
+        {
+          f(i, result, shared_parm);
+        }
+      }
+      else
+      {
+        for(size_t i = 0; i < n; ++i)
+        {
+          f(i, result, shared_parm);
+        }
+      }
+
+      return agency::make_always_ready_future(std::move(result));
+    }
+
+    friend bool operator==(const stoppable_sequenced_executor& a, const stoppable_sequenced_executor& b) noexcept
+    {
+      return a.stop_token_ == b.stop_token_;
+    }
+
+    friend bool operator!=(const stoppable_sequenced_executor& a, const stoppable_sequenced_executor& b) noexcept
+    {
+      return !(a == b);
+    }
+
+  private:
+    stop_token stop_token_;
+};
+
+
+} // end detail
+
+
+inline detail::stoppable_sequenced_executor sequenced_executor::require(const stoppable_t& prop) const
+{
+  return detail::stoppable_sequenced_executor(prop.token());
+}
+
+
 } // end agency
 
@@ -28,7 +28,10 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/type_traits.hpp>
+#include <agency/detail/concurrency/elastic_thread_pool.hpp>
+#include <agency/detail/concurrency/future_poller.hpp>
 #include <agency/future/future_traits/detail/has_then_member.hpp>
+#include <chrono>
 #include <utility>
 #include <future>
 
@@ -39,18 +42,149 @@ namespace detail
 {
 
 
+// these overloads of invoke_continuation() unwrap a ready std::future or std::shared_future
+// and call the continuation with its value
+template<class T, class Function>
+result_of_t<Function(T&)>
+  invoke_continuation(std::future<T>& fut, Function& f)
+{
+  T arg = fut.get();
+  return f(arg);
+}
+
+
+template<class Function>
+result_of_t<Function()>
+  invoke_continuation(std::future<void>& fut, Function& f)
+{
+  fut.get();
+  return f();
+}
+
+
+template<class T, class Function>
+result_of_t<Function(T&)>
+  invoke_continuation(std::shared_future<T>& fut, Function& f)
+{
+  T& arg = const_cast<T&>(fut.get());
+  return f(arg);
+}
+
+
+template<class Function>
+result_of_t<Function()>
+  invoke_continuation(std::shared_future<void>& fut, Function& f)
+{
+  fut.get();
+  return f();
+}
+
+
+// monadic_then_functor calls a continuation with the value of its ready predecessor
+template<class Function>
+struct monadic_then_functor
+{
+  Function f_;
+
+  template<class Future>
+  auto operator()(Future&& fut) ->
+    decltype(detail::invoke_continuation(fut, f_))
+  {
+    return detail::invoke_continuation(fut, f_);
+  }
+};
+
+
+template<class Future, class Function>
+using monadic_then_result_t = decltype(std::declval<monadic_then_functor<decay_t<Function>>>()(std::declval<Future>()));
+
+
+// returns true if waiting on fut would not block until another thread fulfills it
+// a deferred future is ready in this sense, because waiting on it executes its function
+template<class Future>
+bool is_ready(const Future& fut)
+{
+  return fut.wait_for(std::chrono::seconds(0)) != std::future_status::timeout;
+}
+
+
+// ready_continuation is a task which calls a continuation with its ready predecessor
+template<class Future, class Result>
+struct ready_continuation
+{
+  Future fut_;
+  std::packaged_task<Result(Future&&)> task_;
+
+  void operator()()
+  {
+    task_(std::move(fut_));
+  }
+};
+
+
+// poll_continuation is the poll function of a ready_continuation whose predecessor was not ready when it was created
+// once the predecessor becomes ready, it submits the continuation to the elastic thread pool
+template<class Future, class Result>
+struct poll_continuation
+{
+  ready_continuation<Future,Result> continuation_;
+
+  bool operator()()
+  {
+    if(!detail::is_ready(continuation_.fut_)) return false;
+
+    system_elastic_thread_pool().submit(std::move(continuation_));
+    return true;
+  }
+};
+
+
+// monadic_then_impl() schedules the continuation without creating a thread for each continuation
+//
+// when the policy permits asynchronous execution, the continuation executes on a thread of the elastic thread pool,
+// which reuses idle threads, once its predecessor is ready. the continuation may block on other std::futures,
+// and unlike a thread_pool_future, a std::future offers a thread of the system thread pool no way to help
+// execute the work it is waiting on. so the continuation must not occupy a thread of the system thread pool.
+// until its predecessor is ready, a continuation waits in the system future poller, which occupies no thread on
+// the continuation's behalf, so arbitrarily long chains of pending continuations remain cheap.
+// otherwise, the policy requires deferred execution, and the continuation executes when the result is waited on
+template<class Future, class Function>
+auto monadic_then_impl(Future& fut, std::launch policy, Function&& f) ->
+  std::future<monadic_then_result_t<Future,Function>>
+{
+  using result_type = monadic_then_result_t<Future,Function>;
+
+  monadic_then_functor<decay_t<Function>> continuation{std::forward<Function>(f)};
+
+  if((policy & std::launch::async) != std::launch::async)
+  {
+    return std::async(std::launch::deferred, std::move(continuation), std::move(fut));
+  }
+
+  std::packaged_task<result_type(Future&&)> task(std::move(continuation));
+  std::future<result_type> result = task.get_future();
+
+  // create the elastic thread pool before the poller, so that the pool outlives any continuation the poller submits
+  elastic_thread_pool& pool = system_elastic_thread_pool();
+
+  if(detail::is_ready(fut))
+  {
+    pool.submit(ready_continuation<Future,result_type>{std::move(fut), std::move(task)});
+  }
+  else
+  {
+    system_future_poller().add(poll_continuation<Future,result_type>{{std::move(fut), std::move(task)}});
+  }
+
+  return result;
+}
+
+
 template<class T, class Function>
 std::future<detail::result_of_t<Function(T&)>>
   monadic_then(std::future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::future<T>&& fut, Function&& f)
-  {
-    T arg = fut.get();
-    return std::forward<Function>(f)(arg);
-  },
-  std::move(fut),
-  std::forward<Function>(f)
-  );
+  return detail::monadic_then_impl(fut, policy, std::forward<Function>(f));
 }
 
 
@@ -58,14 +192,7 @@ template<class Function>
 std::future<detail::result_of_t<Function()>>
   monadic_then(std::future<void>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::future<void>&& fut, Function&& f)
-  {
-    fut.get();
-    return std::forward<Function>(f)();
-  },
-  std::move(fut),
-  std::forward<Function>(f)
-  );
+  return detail::monadic_then_impl(fut, policy, std::forward<Function>(f));
 }
 
 
@@ -82,14 +209,7 @@ template<class T, class Function>
 std::future<detail::result_of_t<Function(T&)>>
   monadic_then(std::shared_future<T>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::shared_future<T>&& fut, Function&& f)
-  {
-    T& arg = const_cast<T&>(fut.get());
-    return std::forward<Function>(f)(arg);
-  },
-  std::move(fut),
-  std::forward<Function>(f)
-  );
+  return detail::monadic_then_impl(fut, policy, std::forward<Function>(f));
 }
 
 
@@ -97,14 +217,7 @@ template<class Function>
 std::future<detail::result_of_t<Function()>>
   monadic_then(std::shared_future<void>& fut, std::launch policy, Function&& f)
 {
-  return std::async(policy, [](std::shared_future<void>&& fut, Function&& f)
-  {
-    fut.get();
-    return std::forward<Function>(f)();
-  },
-  std::move(fut),
-  std::forward<Function>(f)
-  );
+  return detail::monadic_then_impl(fut, policy, std::forward<Function>(f));
 }
 
 
@@ -2,8 +2,15 @@
 
 #include <agency/detail/config.hpp>
 #include <agency/detail/singleton.hpp>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace agency
 {
@@ -11,6 +18,12 @@ namespace detail
 {
 
 
+// cached_resource retains the blocks deallocated through it and reuses them to satisfy later allocations
+//
+// a request is satisfied by the smallest free block which fits it, so long as that block is no more than twice
+// the size of the request. new blocks are rounded up in size, so that requests whose sizes vary slightly share blocks.
+// the free blocks retained are limited to max_cached_bytes() in total, beyond which the largest free blocks
+// are returned to the base resource. trim() returns free blocks to the base resource explicitly
 template<class MemoryResource>
 class cached_resource : private MemoryResource
 {
@@ -34,39 +47,81 @@ class cached_resource : private MemoryResource
     void* allocate(size_t num_bytes)
     {
       void* ptr = nullptr;
+      size_t block_size = 0;
 
-      // XXX this searches for a block of exactly the right size, but
-      //     in general we could look for anything that fits, which is just
-      //     the textbook malloc implementation
-      auto free_block = free_blocks_.find(num_bytes);
-      if(free_block != free_blocks_.end())
+      // find the smallest free block which fits, but don't waste a large block on a small request
+      auto free_block = free_blocks_.lower_bound(num_bytes);
+      if(free_block != free_blocks_.end() && free_block->first / 2 <= num_bytes)
       {
+        block_size = free_block->first;
         ptr = free_block->second;
 
         // erase from the free blocks map
         free_blocks_.erase(free_block);
+        cached_bytes_ -= block_size;
       }
       else
       {
-        // no allocation of the right size exists
+        // no free block fits
         // create a new allocation with the base resource
-        ptr = resource_type::allocate(num_bytes);
+        block_size = rounded_size(num_bytes);
+        ptr = resource_type::allocate(block_size);
       }
 
       // insert the allocation into the allocated_blocks map
-      allocated_blocks_.insert(std::make_pair(ptr, num_bytes));
+      allocated_blocks_.insert(std::make_pair(ptr, block_size));
 
       return ptr;
     }
 
-    void deallocate(void* ptr, size_t num_bytes)
+    // the size of the block is recorded upon allocation, so num_bytes is not used
+    void deallocate(void* ptr, size_t)
     {
       // erase the allocation from the allocated blocks map
       auto found = allocated_blocks_.find(reinterpret_cast<char*>(ptr));
+      size_t block_size = found->second;
       allocated_blocks_.erase(found);
 
       // insert the block into the free blocks map
-      free_blocks_.insert(std::make_pair(num_bytes, reinterpret_cast<char*>(ptr)));
+      free_blocks_.insert(std::make_pair(block_size, reinterpret_cast<char*>(ptr)));
+      cached_bytes_ += block_size;
+
+      if(cached_bytes_ > max_cached_bytes_)
+      {
+        trim(max_cached_bytes_);
+      }
+    }
+
+    // returns the total size of the free blocks retained
+    size_t cached_bytes() const
+    {
+      return cached_bytes_;
+    }
+
+    size_t max_cached_bytes() const
+    {
+      return max_cached_bytes_;
+    }
+
+    // limits the total size of the free blocks retained to max_bytes
+    void max_cached_bytes(size_t max_bytes)
+    {
+      max_cached_bytes_ = max_bytes;
+      trim(max_cached_bytes_);
+    }
+
+    // returns free blocks to the base resource, largest first, until no more than max_bytes remain cached
+    void trim(size_t max_bytes = 0)
+    {
+      while(cached_bytes_ > max_bytes && !free_blocks_.empty())
+      {
+        auto largest = std::prev(free_blocks_.end());
+
+        resource_type::deallocate(largest->second, largest->first);
+
+        cached_bytes_ -= largest->first;
+        free_blocks_.erase(largest);
+      }
     }
 
     bool operator==(const cached_resource& other) const
@@ -85,6 +140,23 @@ class cached_resource : private MemoryResource
     
     free_blocks_type      free_blocks_;
     allocated_blocks_type allocated_blocks_;
+    size_t                cached_bytes_ = 0;
+    size_t                max_cached_bytes_ = std::numeric_limits<size_t>::max();
+
+    // rounds num_bytes up to the next of four steps between consecutive powers of two
+    // so that no more than a quarter of a block is wasted
+    static size_t rounded_size(size_t num_bytes)
+    {
+      size_t power_of_two = 1;
+      while(power_of_two <= num_bytes / 2)
+      {
+        power_of_two *= 2;
+      }
+
+      size_t step = power_of_two / 4 > 0 ? power_of_two / 4 : 1;
+
+      return (num_bytes + step - 1) / step * step;
+    }
 
     void deallocate_free_blocks()
     {
@@ -104,6 +176,7 @@ class cached_resource : private MemoryResource
         }
       }
       free_blocks_.clear();
+      cached_bytes_ = 0;
 
       // note that we do not attempt to deallocate allocated blocks
       // that's the user's responsibility
@@ -111,11 +184,389 @@ class cached_resource : private MemoryResource
 };
 
 
+// size_class_cached_resource is the tier of a globally_cached_resource shared by all threads
+//
+// small blocks are segregated into power-of-two size classes, and each class's free blocks are kept in a list.
+// threads move blocks to and from these lists in batches, so the lock guarding them is taken rarely.
+// blocks larger than the largest size class are cached by a cached_resource
+//
+// the free blocks retained by this tier are limited to max_cached_bytes() in total, beyond which the largest
+// are returned to the base resource. the same limit applies to the blocks retained by each thread's cache
+template<class MemoryResource>
+class size_class_cached_resource
+{
+  public:
+    // the smallest size class is 2^min_size_class_log2 bytes
+    static constexpr size_t min_size_class_log2 = 4;
+
+    // the largest size class is 2^max_size_class_log2 bytes
+    static constexpr size_t max_size_class_log2 = 20;
+
+    static constexpr size_t num_size_classes = max_size_class_log2 - min_size_class_log2 + 1;
+
+    static constexpr size_t max_size_class_size = size_t(1) << max_size_class_log2;
+
+    size_class_cached_resource()
+      : max_cached_bytes_(std::numeric_limits<size_t>::max()),
+        trim_epoch_(0)
+    {}
+
+    size_class_cached_resource(const size_class_cached_resource&) = delete;
+
+    ~size_class_cached_resource()
+    {
+      for(size_t c = 0; c < num_size_classes; ++c)
+      {
+        for(void* ptr : free_blocks_[c])
+        {
+          // swallow any exceptions in order to avoid propagating exceptions out of destructors
+          try
+          {
+            resource_.deallocate(ptr, size_of_class(c));
+          }
+          catch(...)
+          {
+          }
+        }
+      }
+    }
+
+    // returns the index of the smallest size class which accommodates num_bytes
+    // num_bytes must be no larger than max_size_class_size
+    static size_t size_class(size_t num_bytes)
+    {
+      size_t c = 0;
+      while((size_t(1) << (c + min_size_class_log2)) < num_bytes)
+      {
+        ++c;
+      }
+
+      return c;
+    }
+
+    static size_t size_of_class(size_t c)
+    {
+      return size_t(1) << (c + min_size_class_log2);
+    }
+
+    // stores up to n blocks of size class c in blocks and returns the number stored
+    // blocks are taken from the class's free list. only when the list is empty is a single new block
+    // created with the base resource, so a thread's cache never holds blocks which no thread has asked for
+    size_t allocate_batch(size_t c, void** blocks, size_t n)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      std::vector<void*>& free_blocks = free_blocks_[c];
+
+      size_t num_taken = 0;
+      while(num_taken < n && !free_blocks.empty())
+      {
+        blocks[num_taken++] = free_blocks.back();
+        free_blocks.pop_back();
+      }
+
+      small_cached_bytes_ -= num_taken * size_of_class(c);
+
+      if(num_taken == 0 && n > 0)
+      {
+        // the base resource is not assumed to be thread safe, so create the block while holding the lock
+        void* ptr = resource_.allocate(size_of_class(c));
+        if(ptr)
+        {
+          blocks[num_taken++] = ptr;
+        }
+      }
+
+      return num_taken;
+    }
+
+    // returns n blocks of size class c to the class's free list
+    void deallocate_batch(size_t c, void* const* blocks, size_t n)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      free_blocks_[c].insert(free_blocks_[c].end(), blocks, blocks + n);
+      small_cached_bytes_ += n * size_of_class(c);
+
+      enforce_max_cached_bytes();
+    }
+
+    void* allocate_large(size_t num_bytes)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      return large_blocks_.allocate(num_bytes);
+    }
+
+    void deallocate_large(void* ptr, size_t num_bytes)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      large_blocks_.deallocate(ptr, num_bytes);
+
+      enforce_max_cached_bytes();
+    }
+
+    // returns the total size of the free blocks retained by this tier, excluding those retained by threads' caches
+    size_t cached_bytes() const
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      return small_cached_bytes_ + large_blocks_.cached_bytes();
+    }
+
+    size_t max_cached_bytes() const
+    {
+      return max_cached_bytes_.load(std::memory_order_relaxed);
+    }
+
+    // limits the total size of the free blocks retained by this tier, and by each thread's cache, to max_bytes
+    void max_cached_bytes(size_t max_bytes)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      max_cached_bytes_.store(max_bytes, std::memory_order_relaxed);
+      trim_impl(max_bytes);
+
+      // the threads' caches may now exceed the limit
+      trim_epoch_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // returns free blocks to the base resource, largest first, until no more than max_bytes remain cached by this tier
+    // each thread's cache returns its blocks to this tier the next time its thread allocates or deallocates
+    void trim(size_t max_bytes = 0)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      trim_impl(max_bytes);
+
+      trim_epoch_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // the trim epoch changes with each call to trim(), so that threads' caches may notice it
+    unsigned int trim_epoch() const
+    {
+      return trim_epoch_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // the caller must own mutex_
+    void enforce_max_cached_bytes()
+    {
+      size_t max_bytes = max_cached_bytes_.load(std::memory_order_relaxed);
+
+      if(small_cached_bytes_ + large_blocks_.cached_bytes() > max_bytes)
+      {
+        trim_impl(max_bytes);
+      }
+    }
+
+    // the caller must own mutex_
+    void trim_impl(size_t max_bytes)
+    {
+      // large blocks are larger than any small block, so return them first
+      large_blocks_.trim(max_bytes > small_cached_bytes_ ? max_bytes - small_cached_bytes_ : 0);
+
+      size_t large_cached_bytes = large_blocks_.cached_bytes();
+
+      // then return small blocks, beginning with the largest size class
+      for(size_t c = num_size_classes; c-- > 0 && small_cached_bytes_ + large_cached_bytes > max_bytes; )
+      {
+        std::vector<void*>& free_blocks = free_blocks_[c];
+
+        while(!free_blocks.empty() && small_cached_bytes_ + large_cached_bytes > max_bytes)
+        {
+          resource_.deallocate(free_blocks.back(), size_of_class(c));
+          free_blocks.pop_back();
+          small_cached_bytes_ -= size_of_class(c);
+        }
+      }
+    }
+
+    mutable std::mutex mutex_;
+    MemoryResource resource_;
+    std::vector<void*> free_blocks_[num_size_classes];
+    size_t small_cached_bytes_ = 0;
+    cached_resource<MemoryResource> large_blocks_;
+    std::atomic<size_t> max_cached_bytes_;
+    std::atomic<unsigned int> trim_epoch_;
+};
+
+
+// size_class_thread_cache is a thread's private cache of the small blocks of a size_class_cached_resource
+//
+// each size class has a bin of at most max_bin_size blocks and max_bin_bytes bytes, so bins of large classes
+// hold fewer blocks, and classes too large for even a single block are not cached by the thread at all.
+// an empty bin is refilled with a batch of up to half its capacity from the shared tier, and a full bin
+// returns its oldest half to the shared tier. the cache returns all of its blocks to the shared tier
+// when they exceed the shared tier's max_cached_bytes(), or after the shared tier is trimmed
+template<class MemoryResource>
+class size_class_thread_cache
+{
+  private:
+    using shared_resource_type = size_class_cached_resource<MemoryResource>;
+
+    static constexpr size_t max_bin_size = 32;
+    static constexpr size_t max_bin_bytes = 256 * 1024;
+
+  public:
+    // returns the maximum number of blocks of size class c cached by a thread
+    static size_t bin_capacity(size_t c)
+    {
+      size_t capacity = max_bin_bytes / shared_resource_type::size_of_class(c);
+      return capacity < max_bin_size ? capacity : max_bin_size;
+    }
+
+  private:
+    static size_t batch_size(size_t c)
+    {
+      return (bin_capacity(c) + 1) / 2;
+    }
+
+  public:
+    size_class_thread_cache(shared_resource_type& shared_resource)
+      : shared_resource_(shared_resource),
+        cached_bytes_(0),
+        trim_epoch_(shared_resource.trim_epoch())
+    {
+      for(auto& bin : bins_)
+      {
+        bin.size = 0;
+      }
+    }
+
+    size_class_thread_cache(const size_class_thread_cache&) = delete;
+
+    shared_resource_type& shared_resource() const
+    {
+      return shared_resource_;
+    }
+
+    // returns the total size of the blocks retained by this cache
+    size_t cached_bytes() const
+    {
+      return cached_bytes_;
+    }
+
+    // returns the cached blocks to the shared tier
+    void flush()
+    {
+      for(size_t c = 0; c < shared_resource_type::num_size_classes; ++c)
+      {
+        if(bins_[c].size > 0)
+        {
+          shared_resource_.deallocate_batch(c, bins_[c].blocks, bins_[c].size);
+          bins_[c].size = 0;
+        }
+      }
+
+      cached_bytes_ = 0;
+    }
+
+    void* allocate(size_t num_bytes)
+    {
+      flush_if_trimmed();
+
+      if(num_bytes > shared_resource_type::max_size_class_size)
+      {
+        return shared_resource_.allocate_large(num_bytes);
+      }
+
+      size_t c = shared_resource_type::size_class(num_bytes);
+      bin& b = bins_[c];
+
+      if(b.size == 0)
+      {
+        if(bin_capacity(c) == 0)
+        {
+          // this class is not cached by the thread, so take a single block from the shared tier
+          void* ptr = nullptr;
+          shared_resource_.allocate_batch(c, &ptr, 1);
+          return ptr;
+        }
+
+        b.size = shared_resource_.allocate_batch(c, b.blocks, batch_size(c));
+
+        if(b.size == 0) return nullptr;
+
+        cached_bytes_ += b.size * shared_resource_type::size_of_class(c);
+      }
+
+      cached_bytes_ -= shared_resource_type::size_of_class(c);
+
+      return b.blocks[--b.size];
+    }
+
+    void deallocate(void* ptr, size_t num_bytes)
+    {
+      flush_if_trimmed();
+
+      if(num_bytes > shared_resource_type::max_size_class_size)
+      {
+        shared_resource_.deallocate_large(ptr, num_bytes);
+        return;
+      }
+
+      size_t c = shared_resource_type::size_class(num_bytes);
+      bin& b = bins_[c];
+      size_t capacity = bin_capacity(c);
+
+      if(capacity == 0)
+      {
+        // this class is not cached by the thread, so return the block directly to the shared tier
+        shared_resource_.deallocate_batch(c, &ptr, 1);
+        return;
+      }
+
+      if(b.size == capacity)
+      {
+        // return the oldest half of the bin to the shared tier
+        size_t n = batch_size(c);
+        shared_resource_.deallocate_batch(c, b.blocks, n);
+        std::copy(b.blocks + n, b.blocks + capacity, b.blocks);
+        b.size -= n;
+        cached_bytes_ -= n * shared_resource_type::size_of_class(c);
+      }
+
+      b.blocks[b.size++] = ptr;
+      cached_bytes_ += shared_resource_type::size_of_class(c);
+
+      if(cached_bytes_ > shared_resource_.max_cached_bytes())
+      {
+        flush();
+      }
+    }
+
+  private:
+    void flush_if_trimmed()
+    {
+      unsigned int epoch = shared_resource_.trim_epoch();
+
+      if(epoch != trim_epoch_)
+      {
+        trim_epoch_ = epoch;
+        flush();
+      }
+    }
+
+    struct bin
+    {
+      size_t size;
+      void* blocks[max_bin_size];
+    };
+
+    shared_resource_type& shared_resource_;
+    size_t cached_bytes_;
+    unsigned int trim_epoch_;
+    bin bins_[shared_resource_type::num_size_classes];
+};
+
+
 template<class MemoryResource>
 struct cached_resources_singleton_t
 {
   std::mutex mutex;
-  std::map<MemoryResource, cached_resource<MemoryResource>> cached_resources;
+  std::map<MemoryResource, size_class_cached_resource<MemoryResource>> cached_resources;
 };
 
 
@@ -126,42 +577,98 @@ inline cached_resources_singleton_t<MemoryResource>* cached_resources_singleton(
 }
 
 
+// this_thread_caches owns the calling thread's size_class_thread_caches, one for each MemoryResource
+// a thread's caches return their blocks to the shared tiers when the thread exits
 template<class MemoryResource>
-inline void* allocate_from_cached_resources_singleton(const MemoryResource& resource, size_t num_bytes)
+class this_thread_caches
 {
-  void* result = nullptr;
+  public:
+    this_thread_caches() = default;
 
-  cached_resources_singleton_t<MemoryResource>* resources_ptr = cached_resources_singleton<MemoryResource>();
+    ~this_thread_caches()
+    {
+      // the shared tiers may have been destroyed already, during the static destruction of the program
+      if(cached_resources_singleton<MemoryResource>())
+      {
+        for(auto& cache : caches_)
+        {
+          cache.second->flush();
+        }
+      }
+    }
 
-  if(resources_ptr)
-  {
-    // lock the resources
-    std::lock_guard<std::mutex> guard(resources_ptr->mutex);
+    // returns the calling thread's cache of the given resource, or nullptr if the shared tiers no longer exist
+    size_class_thread_cache<MemoryResource>* find_or_create(const MemoryResource& resource)
+    {
+      for(auto& cache : caches_)
+      {
+        // resources are equivalent when neither orders before the other
+        if(!(cache.first < resource) && !(resource < cache.first))
+        {
+          return cache.second.get();
+        }
+      }
 
-    // allocate using the cached resource associated with the given resource
-    result = resources_ptr->cached_resources[resource].allocate(num_bytes);
-  }
+      cached_resources_singleton_t<MemoryResource>* resources_ptr = cached_resources_singleton<MemoryResource>();
+
+      if(!resources_ptr) return nullptr;
+
+      size_class_cached_resource<MemoryResource>* shared_resource = nullptr;
+
+      {
+        // lock the resources
+        std::lock_guard<std::mutex> guard(resources_ptr->mutex);
+
+        // the map's elements never move, so the shared tier may be used after the lock is released
+        shared_resource = &resources_ptr->cached_resources[resource];
+      }
+
+      caches_.emplace_back(resource, std::unique_ptr<size_class_thread_cache<MemoryResource>>(new size_class_thread_cache<MemoryResource>(*shared_resource)));
+
+      return caches_.back().second.get();
+    }
+
+  private:
+    std::vector<std::pair<MemoryResource, std::unique_ptr<size_class_thread_cache<MemoryResource>>>> caches_;
+};
+
+
+template<class MemoryResource>
+inline size_class_thread_cache<MemoryResource>* this_thread_cache(const MemoryResource& resource)
+{
+  static thread_local this_thread_caches<MemoryResource> caches;
 
-  return result;
+  return caches.find_or_create(resource);
+}
+
+
+template<class MemoryResource>
+inline void* allocate_from_cached_resources_singleton(const MemoryResource& resource, size_t num_bytes)
+{
+  size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource);
+
+  return cache ? cache->allocate(num_bytes) : nullptr;
 }
 
 
 template<class MemoryResource>
 inline void deallocate_from_cached_resources_singleton(const MemoryResource& resource, void* ptr, size_t num_bytes)
 {
-  cached_resources_singleton_t<MemoryResource>* resources_ptr = cached_resources_singleton<MemoryResource>();
+  size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource);
 
-  if(resources_ptr)
+  if(cache)
   {
-    // lock the resources
-    std::lock_guard<std::mutex> guard(resources_ptr->mutex);
-
-    // deallocate using the cached resource associated with the given resource
-    resources_ptr->cached_resources[resource].deallocate(ptr, num_bytes);
+    cache->deallocate(ptr, num_bytes);
   }
 }
 
 
+// globally_cached_resource caches the blocks of the MemoryResource equivalent to its own
+// in a tier shared by all threads, and in a private cache of each thread. most allocations
+// are served by the calling thread's cache without taking any lock
+//
+// as the caches are shared by all globally_cached_resources whose MemoryResources are equivalent,
+// so are the limit set by max_cached_bytes(n) and the effect of trim()
 template<class MemoryResource>
 class globally_cached_resource
 {
@@ -186,6 +693,47 @@ class globally_cached_resource
       deallocate_from_cached_resources_singleton(resource_, ptr, num_bytes);
     }
 
+    // returns the total size of the free blocks retained by the shared tier and by the calling thread's cache
+    size_t cached_bytes() const
+    {
+      size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource_);
+
+      return cache ? cache->shared_resource().cached_bytes() + cache->cached_bytes() : 0;
+    }
+
+    size_t max_cached_bytes() const
+    {
+      size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource_);
+
+      return cache ? cache->shared_resource().max_cached_bytes() : 0;
+    }
+
+    // limits the total size of the free blocks retained by the shared tier, and by each thread's cache, to max_bytes
+    void max_cached_bytes(size_t max_bytes)
+    {
+      size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource_);
+
+      if(cache)
+      {
+        cache->flush();
+        cache->shared_resource().max_cached_bytes(max_bytes);
+      }
+    }
+
+    // returns the calling thread's cached blocks to the shared tier, and then returns the shared tier's free blocks
+    // to the base resource, largest first, until no more than max_bytes remain cached.
+    // other threads return their cached blocks to the shared tier the next time they allocate or deallocate
+    void trim(size_t max_bytes = 0)
+    {
+      size_class_thread_cache<MemoryResource>* cache = this_thread_cache(resource_);
+
+      if(cache)
+      {
+        cache->flush();
+        cache->shared_resource().trim(max_bytes);
+      }
+    }
+
     bool operator==(const globally_cached_resource& other) const
     {
       return resource_ == other.resource_;
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <agency/detail/config.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+namespace agency
+{
+namespace detail
+{
+
+
+// scratch_cache holds blocks of memory released by scratch_resources for reuse
+// each thread has its own scratch_cache, so acquiring and releasing blocks requires no synchronization
+class scratch_cache
+{
+  public:
+    struct block
+    {
+      char* ptr;
+      std::size_t size;
+    };
+
+    // the number of blocks a cache holds before it returns blocks to the system
+    static constexpr std::size_t max_num_blocks = 4;
+
+    scratch_cache() = default;
+
+    scratch_cache(const scratch_cache&) = delete;
+
+    ~scratch_cache()
+    {
+      for(block& b : blocks_)
+      {
+        std::free(b.ptr);
+      }
+    }
+
+    // returns the smallest cached block of at least num_bytes, or a newly allocated block if there is none
+    // the returned block's ptr is null if allocation fails
+    block acquire(std::size_t num_bytes)
+    {
+      auto best = blocks_.end();
+
+      for(auto b = blocks_.begin(); b != blocks_.end(); ++b)
+      {
+        if(b->size >= num_bytes && (best == blocks_.end() || b->size < best->size))
+        {
+          best = b;
+        }
+      }
+
+      if(best != blocks_.end())
+      {
+        block result = *best;
+        blocks_.erase(best);
+        return result;
+      }
+
+      return block{static_cast<char*>(std::malloc(num_bytes)), num_bytes};
+    }
+
+    void release(block b)
+    {
+      blocks_.push_back(b);
+
+      if(blocks_.size() > max_num_blocks)
+      {
+        // evict the smallest block, which is the least likely to satisfy future requests
+        auto smallest = blocks_.begin();
+        for(auto i = blocks_.begin(); i != blocks_.end(); ++i)
+        {
+          if(i->size < smallest->size) smallest = i;
+        }
+
+        std::free(smallest->ptr);
+        blocks_.erase(smallest);
+      }
+    }
+
+    static scratch_cache& this_thread()
+    {
+      static thread_local scratch_cache cache;
+      return cache;
+    }
+
+  private:
+    std::vector<block> blocks_;
+};
+
+
+// scratch_resource is a C++ "memory resource" which allocates memory from a block whose size is chosen at construction
+//
+// the block comes from the scratch_cache of the thread constructing the scratch_resource, and upon destruction
+// the block returns to the scratch_cache of the destroying thread. so, repeatedly creating scratch_resources of
+// similar sizes on a thread does not touch the system's allocator
+//
+// like arena_resource, only the most recent allocation is actually reclaimed upon deallocation.
+// a scratch_resource whose size is zero, and any scratch_resource in device code, owns no memory and
+// fails every allocation by returning null
+class scratch_resource
+{
+  public:
+    __AGENCY_ANNOTATION
+    scratch_resource() noexcept
+      : scratch_resource(0)
+    {}
+
+    __AGENCY_ANNOTATION
+    explicit scratch_resource(std::size_t capacity) noexcept
+      : begin_(nullptr),
+        capacity_(0),
+        size_(0)
+    {
+#ifndef __CUDA_ARCH__
+      if(capacity > 0)
+      {
+        scratch_cache::block b = scratch_cache::this_thread().acquire(capacity);
+
+        if(b.ptr)
+        {
+          begin_ = b.ptr;
+          capacity_ = b.size;
+        }
+      }
+#endif
+    }
+
+    __AGENCY_ANNOTATION
+    scratch_resource(const scratch_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    scratch_resource& operator=(const scratch_resource&) = delete;
+
+    __AGENCY_ANNOTATION
+    ~scratch_resource()
+    {
+#ifndef __CUDA_ARCH__
+      if(begin_)
+      {
+        scratch_cache::this_thread().release(scratch_cache::block{begin_, capacity_});
+      }
+#endif
+    }
+
+    __AGENCY_ANNOTATION
+    void* allocate(std::size_t n) noexcept
+    {
+      std::size_t offset = align_up(size_);
+
+      if(offset + n > capacity_)
+      {
+        return nullptr;
+      }
+
+      size_ = offset + n;
+      return begin_ + offset;
+    }
+
+    __AGENCY_ANNOTATION
+    void deallocate(void* p, std::size_t n) noexcept
+    {
+      char* ptr = reinterpret_cast<char*>(p);
+
+      // reclaim the most recent allocation
+      if(ptr + n == begin_ + size_)
+      {
+        size_ = ptr - begin_;
+      }
+    }
+
+    __AGENCY_ANNOTATION
+    bool owns(void* p, std::size_t) const noexcept
+    {
+      char* ptr = reinterpret_cast<char*>(p);
+
+      return begin_ <= ptr && ptr < begin_ + capacity_;
+    }
+
+    __AGENCY_ANNOTATION
+    std::size_t capacity() const noexcept
+    {
+      return capacity_;
+    }
+
+  private:
+    __AGENCY_ANNOTATION
+    static std::size_t align_up(std::size_t n) noexcept
+    {
+      const std::size_t alignment = alignof(std::max_align_t);
+      return (n + (alignment-1)) & ~(alignment-1);
+    }
+
+    char* begin_;
+    std::size_t capacity_;
+    std::size_t size_;
+};
+
+
+} // end detail
+} // end agency
+
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <agency/detail/config.hpp>
+#include <agency/detail/requires.hpp>
 #include <cstddef>
+#include <type_traits>
+#include <utility>
 
 namespace agency
 {
@@ -16,6 +19,19 @@ class tiered_resource : private MemoryResource1, private MemoryResource2
     using primary_resource_type = MemoryResource1;
     using fallback_resource_type = MemoryResource2;
 
+    tiered_resource() = default;
+
+    // constructs the primary resource from arg and default constructs the fallback resource
+    template<class Arg,
+             __AGENCY_REQUIRES(
+               std::is_constructible<primary_resource_type, Arg&&>::value
+             )>
+    __AGENCY_ANNOTATION
+    explicit tiered_resource(Arg&& arg)
+      : primary_resource_type(std::forward<Arg>(arg)),
+        fallback_resource_type()
+    {}
+
     __AGENCY_ANNOTATION
     void* allocate(std::size_t n)
     {
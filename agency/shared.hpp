@@ -31,9 +31,7 @@ T* collective_new(ConcurrentAgent& self, Args&&... args)
     ::new(ptr) T(std::forward<Args>(args)...);
   }
 
-  // we wait because .broadcast() may do side effects on self.memory_resource()
-  // XXX we can eliminate this barrier in cases where we can prove that .broadcast() does not use self.memory_resource()
-  self.wait();
+  // note that broadcasting a pointer does not use self.memory_resource(), so there's no need to wait before broadcasting
 
   using namespace agency::experimental;
   return self.broadcast(ptr ? make_optional(ptr) : nullopt);
@@ -143,9 +141,7 @@ T* collective_new_array(ConcurrentAgent& self, size_t n, Args&&... args)
     }
   }
 
-  // we wait because .broadcast() may do side effects on self.memory_resource()
-  // XXX we can eliminate this barrier in cases where we can prove that .broadcast() does not use self.memory_resource()
-  self.wait();
+  // note that broadcasting a pointer does not use self.memory_resource(), so there's no need to wait before broadcasting
 
   using namespace agency::experimental;
   return self.broadcast(ptr ? make_optional(ptr) : nullopt);
@@ -0,0 +1,79 @@
+// This program measures the latency of a barrier phase, i.e. the average time each
+// participant spends in arrive_and_wait(), as the number of participants grows from 2 to 256.
+//
+// It compares agency::detail's blocking_barrier, which takes a lock and waits on a condition
+// variable, spinning_barrier, which spins without bound, hybrid_barrier, which spins for
+// a bounded time before it parks, and tree_barrier, which combines arrivals in a tree rather than
+// on a single counter. Because spinning_barrier never yields its processor, it is measured only
+// when every participant has a processor of its own.
+
+#include <agency/detail/concurrency/barrier.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+// returns the average latency in microseconds of num_phases phases of a barrier with num_threads participants
+template<class Barrier>
+double measure_latency(size_t num_threads, size_t num_phases)
+{
+  Barrier barrier(num_threads);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&]
+    {
+      for(size_t phase = 0; phase < num_phases; ++phase)
+      {
+        barrier.arrive_and_wait();
+      }
+    });
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return elapsed.count() / num_phases;
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  const size_t num_phases = 1000;
+
+  size_t num_processors = available_concurrency();
+
+  std::printf("%8s %16s %16s %16s %16s\n", "threads", "blocking (us)", "spinning (us)", "hybrid (us)", "tree (us)");
+
+  for(size_t num_threads = 2; num_threads <= 256; num_threads *= 2)
+  {
+    double blocking_latency = measure_latency<blocking_barrier>(num_threads, num_phases);
+    double hybrid_latency = measure_latency<hybrid_barrier>(num_threads, num_phases);
+    double tree_latency = measure_latency<tree_barrier>(num_threads, num_phases);
+
+    if(num_threads <= num_processors)
+    {
+      double spinning_latency = measure_latency<spinning_barrier>(num_threads, num_phases);
+
+      std::printf("%8zu %16.2f %16.2f %16.2f %16.2f\n", num_threads, blocking_latency, spinning_latency, hybrid_latency, tree_latency);
+    }
+    else
+    {
+      std::printf("%8zu %16.2f %16s %16.2f %16.2f\n", num_threads, blocking_latency, "-", hybrid_latency, tree_latency);
+    }
+  }
+
+  return 0;
+}
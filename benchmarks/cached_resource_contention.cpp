@@ -0,0 +1,134 @@
+// This program measures the throughput of allocating and deallocating small blocks of varying size
+// through a cached memory resource shared by 1 to N parallel agents executing on agency's thread pool.
+//
+// It compares globally_cached_resource, which serves most requests from a thread's private cache,
+// against the cached_resource guarded by a single mutex which globally_cached_resource previously used,
+// and against the system's malloc and free.
+
+#include <agency/agency.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/memory/detail/resource/cached_resource.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+
+using clock_type = std::chrono::high_resolution_clock;
+
+const size_t num_operations_per_agent = 200000;
+
+// each agent keeps this many blocks live at once
+const size_t working_set_size = 64;
+
+
+struct malloc_resource
+{
+  void* allocate(size_t num_bytes)
+  {
+    return std::malloc(num_bytes);
+  }
+
+  void deallocate(void* ptr, size_t)
+  {
+    std::free(ptr);
+  }
+};
+
+bool operator==(const malloc_resource&, const malloc_resource&)
+{
+  return true;
+}
+
+bool operator!=(const malloc_resource&, const malloc_resource&)
+{
+  return false;
+}
+
+bool operator<(const malloc_resource&, const malloc_resource&)
+{
+  return false;
+}
+
+
+// locked_cached_resource is the design globally_cached_resource previously used:
+// a single cached_resource shared by all threads and guarded by a single mutex
+class locked_cached_resource
+{
+  public:
+    void* allocate(size_t num_bytes)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      return resource_.allocate(num_bytes);
+    }
+
+    void deallocate(void* ptr, size_t num_bytes)
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      resource_.deallocate(ptr, num_bytes);
+    }
+
+  private:
+    std::mutex mutex_;
+    agency::detail::cached_resource<malloc_resource> resource_;
+};
+
+
+// returns the throughput in millions of operations per second of num_agents agents
+// allocating and deallocating blocks of varying size through the given resource
+template<class Resource>
+double measure(Resource& resource, size_t num_agents)
+{
+  auto start = clock_type::now();
+
+  agency::bulk_invoke(agency::par(num_agents), [&](agency::parallel_agent& self)
+  {
+    void* blocks[working_set_size] = {};
+    size_t sizes[working_set_size] = {};
+
+    size_t seed = self.index() + 1;
+
+    for(size_t i = 0; i < num_operations_per_agent; ++i)
+    {
+      size_t j = i % working_set_size;
+
+      if(blocks[j])
+      {
+        resource.deallocate(blocks[j], sizes[j]);
+      }
+
+      // choose a size between 16 and 4096 bytes
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      sizes[j] = 16 + (seed >> 33) % 4081;
+      blocks[j] = resource.allocate(sizes[j]);
+    }
+
+    for(size_t j = 0; j < working_set_size; ++j)
+    {
+      resource.deallocate(blocks[j], sizes[j]);
+    }
+  });
+
+  std::chrono::duration<double> elapsed = clock_type::now() - start;
+  return (num_agents * num_operations_per_agent) / elapsed.count() / 1e6;
+}
+
+
+int main()
+{
+  size_t num_processors = agency::detail::available_concurrency();
+
+  malloc_resource malloc;
+  locked_cached_resource locked;
+  agency::detail::globally_cached_resource<malloc_resource> global;
+
+  std::printf("%8s %24s %24s %24s\n", "agents", "malloc (Mops/s)", "locked cached (Mops/s)", "globally cached (Mops/s)");
+
+  for(size_t num_agents = 1; num_agents <= num_processors; num_agents *= 2)
+  {
+    std::printf("%8zu %24.2f %24.2f %24.2f\n", num_agents, measure(malloc, num_agents), measure(locked, num_agents), measure(global, num_agents));
+  }
+
+  return 0;
+}
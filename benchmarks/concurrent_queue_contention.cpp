@@ -0,0 +1,106 @@
+// This program measures the throughput of agency::detail's concurrent queue implementations
+// as the number of producer and consumer threads contending for a single queue grows from 1 to 64.
+//
+// It compares atomic_wait_concurrent_queue and condition_variable_concurrent_queue, which guard a
+// std::queue with a lock, against bounded_concurrent_queue, which is a lock-free ring buffer.
+
+#include <agency/detail/concurrency/concurrent_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+
+// pushes num_items items through the given queue from num_threads producers to num_threads consumers
+// and returns the number of items transferred per second
+template<class Queue>
+double measure_throughput(size_t num_threads, size_t num_items)
+{
+  Queue queue;
+
+  std::atomic<size_t> num_popped(0);
+  std::atomic<size_t> sum(0);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> consumers;
+  for(size_t c = 0; c < num_threads; ++c)
+  {
+    consumers.emplace_back([&]
+    {
+      size_t item = 0;
+      while(queue.wait_and_pop(item))
+      {
+        sum.fetch_add(item, std::memory_order_relaxed);
+        num_popped.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for(size_t p = 0; p < num_threads; ++p)
+  {
+    producers.emplace_back([&,p]
+    {
+      size_t begin = p * num_items / num_threads;
+      size_t end = (p + 1) * num_items / num_threads;
+
+      for(size_t i = begin; i < end; ++i)
+      {
+        queue.push(i);
+      }
+    });
+  }
+
+  for(auto& t : producers)
+  {
+    t.join();
+  }
+
+  while(num_popped.load(std::memory_order_relaxed) < num_items)
+  {
+    std::this_thread::yield();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  queue.close();
+
+  for(auto& t : consumers)
+  {
+    t.join();
+  }
+
+  // check that every item arrived exactly once
+  if(sum.load() != num_items * (num_items - 1) / 2)
+  {
+    std::fprintf(stderr, "error: items were lost or duplicated\n");
+    std::abort();
+  }
+
+  return num_items / elapsed.count();
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  const size_t num_items = 1 << 18;
+
+  std::printf("%8s %24s %24s %24s\n", "threads", "atomic wait (items/s)", "cond. variable (items/s)", "lock-free (items/s)");
+
+  for(size_t num_threads = 1; num_threads <= 64; num_threads *= 2)
+  {
+    double atomic_wait_throughput = measure_throughput<atomic_wait_concurrent_queue<size_t>>(num_threads, num_items);
+    double condition_variable_throughput = measure_throughput<condition_variable_concurrent_queue<size_t>>(num_threads, num_items);
+    double lock_free_throughput = measure_throughput<bounded_concurrent_queue<size_t>>(num_threads, num_items);
+
+    std::printf("%8zu %24.0f %24.0f %24.0f\n", num_threads, atomic_wait_throughput, condition_variable_throughput, lock_free_throughput);
+  }
+
+  return 0;
+}
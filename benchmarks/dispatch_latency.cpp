@@ -0,0 +1,95 @@
+// This program measures the latency of dispatching a task to an idle thread pool,
+// i.e. the time from submitting the task until a worker begins executing it.
+//
+// It compares idle policies which park idle workers immediately, which yield before
+// parking, and which busy-poll before parking.
+
+#include <agency/detail/concurrency/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+using clock_type = std::chrono::high_resolution_clock;
+
+
+// submits num_samples tasks to the given pool one at a time, allowing the pool to become idle
+// before each submission, and returns the submit-to-start latency of each task in microseconds
+std::vector<double> measure_latencies(agency::detail::thread_pool& pool, size_t num_samples)
+{
+  std::vector<double> result;
+
+  for(size_t i = 0; i < num_samples; ++i)
+  {
+    // give the workers time to run out of work and begin waiting
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+    std::atomic<bool> started(false);
+    clock_type::time_point start_time;
+
+    clock_type::time_point submit_time = clock_type::now();
+
+    pool.submit([&]
+    {
+      start_time = clock_type::now();
+      started.store(true);
+    });
+
+    while(!started.load())
+    {
+      std::this_thread::yield();
+    }
+
+    std::chrono::duration<double, std::micro> latency = start_time - submit_time;
+    result.push_back(latency.count());
+  }
+
+  std::sort(result.begin(), result.end());
+
+  return result;
+}
+
+
+int main()
+{
+  using idle_policy = agency::detail::thread_pool::idle_policy;
+
+  const size_t num_samples = 2000;
+
+  // the calling thread polls for each task's start, so leave a processor for it
+  size_t num_threads = std::max<size_t>(1, agency::detail::available_concurrency() - 1);
+
+  struct named_policy
+  {
+    const char* name;
+    idle_policy policy;
+  };
+
+  std::vector<named_policy> policies = {
+    {"park",       idle_policy()},
+    {"yield",      idle_policy(0, 1 << 14)},
+    {"spin",       idle_policy(1 << 20, 0)}
+  };
+
+  std::printf("%8s %16s %16s %16s\n", "policy", "median (us)", "99th pct. (us)", "max (us)");
+
+  for(const named_policy& p : policies)
+  {
+    agency::detail::thread_pool pool(num_threads, p.policy);
+
+    std::vector<double> latencies = measure_latencies(pool, num_samples);
+
+    std::printf("%8s %16.2f %16.2f %16.2f\n",
+      p.name,
+      latencies[latencies.size() / 2],
+      latencies[latencies.size() * 99 / 100],
+      latencies.back()
+    );
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+// This program measures the memory bandwidth of a streaming triad kernel, a[i] = b[i] + s * c[i].
+//
+// It compares bulk_invoke() on a parallel_executor, whose agents may execute on any processor,
+// against one numa_executor per NUMA node, each of which processes its own slice of the arrays.
+// In the NUMA version, each node's slice is initialized by that node's workers, so a first-touch
+// allocation policy places the slice's pages in the node's local memory.
+
+#include <agency/agency.hpp>
+#include <agency/execution/executor/numa_executor.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <cstdio>
+#include <vector>
+
+
+// runs f() num_trials times and returns the fastest time in seconds
+template<class Function>
+double fastest_time(size_t num_trials, Function f)
+{
+  double result = 0;
+
+  for(size_t trial = 0; trial < num_trials; ++trial)
+  {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    f();
+
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    if(trial == 0 || elapsed.count() < result)
+    {
+      result = elapsed.count();
+    }
+  }
+
+  return result;
+}
+
+
+// converts the time to execute the triad over n elements into GB/s
+double bandwidth(size_t n, double seconds)
+{
+  // the triad reads two arrays and writes one
+  return 3 * sizeof(double) * n / seconds / 1e9;
+}
+
+
+// executes f(i) for each i in [0, n), where each node's executor executes its own slice of the indices
+template<class Function>
+void for_each_slice(size_t n, Function f)
+{
+  std::vector<size_t> node_ids = agency::numa_executor::node_ids();
+  size_t num_nodes = node_ids.size();
+
+  std::vector<std::future<void>> futures;
+
+  for(size_t node = 0; node < num_nodes; ++node)
+  {
+    size_t first = node * n / num_nodes;
+    size_t last = (node + 1) * n / num_nodes;
+
+    agency::numa_executor exec(node_ids[node]);
+
+    futures.push_back(agency::bulk_async(agency::par(last - first).on(exec), [=](agency::parallel_agent& self)
+    {
+      f(first + self.index());
+    }));
+  }
+
+  for(auto& future : futures)
+  {
+    future.wait();
+  }
+}
+
+
+int main()
+{
+  const size_t n = 1 << 25;
+  const size_t num_trials = 10;
+  const double s = 3;
+
+  size_t num_nodes = agency::numa_executor::num_nodes();
+
+  std::printf("%8s %24s %24s\n", "nodes", "parallel (GB/s)", "numa (GB/s)");
+
+  double parallel_seconds = 0;
+  {
+    std::vector<double> a(n), b(n, 1), c(n, 2);
+
+    double* a_ptr = a.data();
+    const double* b_ptr = b.data();
+    const double* c_ptr = c.data();
+
+    parallel_seconds = fastest_time(num_trials, [&]
+    {
+      agency::bulk_invoke(agency::par(n), [=](agency::parallel_agent& self)
+      {
+        size_t i = self.index();
+        a_ptr[i] = b_ptr[i] + s * c_ptr[i];
+      });
+    });
+  }
+
+  double numa_seconds = 0;
+  {
+    // allocate without touching the pages, so that each node's workers touch their own slice first
+    std::unique_ptr<double[]> a(new double[n]), b(new double[n]), c(new double[n]);
+
+    double* a_ptr = a.get();
+    double* b_ptr = b.get();
+    double* c_ptr = c.get();
+
+    for_each_slice(n, [=](size_t i)
+    {
+      a_ptr[i] = 0;
+      b_ptr[i] = 1;
+      c_ptr[i] = 2;
+    });
+
+    numa_seconds = fastest_time(num_trials, [&]
+    {
+      for_each_slice(n, [=](size_t i)
+      {
+        a_ptr[i] = b_ptr[i] + s * c_ptr[i];
+      });
+    });
+  }
+
+  std::printf("%8zu %24.2f %24.2f\n", num_nodes, bandwidth(n, parallel_seconds), bandwidth(n, numa_seconds));
+
+  return 0;
+}
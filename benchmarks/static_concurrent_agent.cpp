@@ -0,0 +1,153 @@
+// This program measures the cost of synchronizing and reducing within small concurrent groups
+// of 2 to 16 agents, whose size is either dynamic (concurrent_agent) or known at compile time
+// (experimental::static_concurrent_agent).
+//
+// For reference, it also measures a hand-written sense-reversing spin barrier executed by
+// std::threads, which is the cost a static_concurrent_agent's wait() aims to approach.
+// Because that barrier never yields its processor, it is measured only when every participant
+// has a processor of its own.
+
+#include <agency/agency.hpp>
+#include <agency/experimental.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+using clock_type = std::chrono::high_resolution_clock;
+
+const size_t num_phases = 10000;
+
+
+struct plus
+{
+  template<class T>
+  T operator()(const T& a, const T& b) const
+  {
+    return a + b;
+  }
+};
+
+
+// returns the average time in microseconds of one phase of a spin barrier shared by num_threads std::threads
+double measure_spin_barrier(size_t num_threads)
+{
+  std::atomic<size_t> count(num_threads);
+  std::atomic<bool> sense(false);
+
+  auto start = clock_type::now();
+
+  std::vector<std::thread> threads;
+  for(size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&]
+    {
+      bool local_sense = false;
+
+      for(size_t phase = 0; phase < num_phases; ++phase)
+      {
+        local_sense = !local_sense;
+
+        if(count.fetch_sub(1) == 1)
+        {
+          count.store(num_threads);
+          sense.store(local_sense);
+        }
+        else
+        {
+          while(sense.load() != local_sense) {}
+        }
+      }
+    });
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  std::chrono::duration<double, std::micro> elapsed = clock_type::now() - start;
+  return elapsed.count() / num_phases;
+}
+
+
+// returns the average time in microseconds of one phase of the given operation within a group created by policy
+template<class ExecutionPolicy, class Operation>
+double measure_group(ExecutionPolicy policy, Operation op)
+{
+  using agent_type = typename ExecutionPolicy::execution_agent_type;
+
+  auto start = clock_type::now();
+
+  agency::bulk_invoke(policy, [=](agent_type& self)
+  {
+    for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      op(self);
+    }
+  });
+
+  std::chrono::duration<double, std::micro> elapsed = clock_type::now() - start;
+  return elapsed.count() / num_phases;
+}
+
+
+struct wait_operation
+{
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    self.wait();
+  }
+};
+
+
+struct all_reduce_operation
+{
+  template<class Agent>
+  void operator()(Agent& self) const
+  {
+    self.all_reduce(int(self.rank()), plus());
+  }
+};
+
+
+template<size_t group_size>
+void measure(size_t num_processors)
+{
+  auto dynamic_policy = agency::con(group_size);
+  auto static_policy = agency::experimental::static_concurrent_execution_policy<group_size>();
+
+  double dynamic_wait = measure_group(dynamic_policy, wait_operation());
+  double static_wait = measure_group(static_policy, wait_operation());
+  double dynamic_reduce = measure_group(dynamic_policy, all_reduce_operation());
+  double static_reduce = measure_group(static_policy, all_reduce_operation());
+
+  if(group_size <= num_processors)
+  {
+    std::printf("%8zu %16.3f %16.3f %16.3f %16.3f %16.3f\n", group_size, measure_spin_barrier(group_size), dynamic_wait, static_wait, dynamic_reduce, static_reduce);
+  }
+  else
+  {
+    std::printf("%8zu %16s %16.3f %16.3f %16.3f %16.3f\n", group_size, "-", dynamic_wait, static_wait, dynamic_reduce, static_reduce);
+  }
+}
+
+
+int main()
+{
+  size_t num_processors = agency::detail::available_concurrency();
+
+  std::printf("%8s %16s %16s %16s %16s %16s\n", "agents", "spin (us)", "wait (us)", "static wait (us)", "reduce (us)", "static red. (us)");
+
+  measure<2>(num_processors);
+  measure<4>(num_processors);
+  measure<8>(num_processors);
+  measure<16>(num_processors);
+
+  return 0;
+}
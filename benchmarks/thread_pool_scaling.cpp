@@ -0,0 +1,137 @@
+// This program measures the throughput of submitting tiny tasks to a thread pool and
+// popping them from the pool as the number of threads grows.
+//
+// It compares agency::detail::thread_pool, which distributes tasks among per-worker
+// work-stealing deques, against a reference pool whose workers all share a single queue.
+
+#include <agency/detail/concurrency/thread_pool.hpp>
+#include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <agency/detail/unique_function.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+// single_queue_pool is a pool whose workers all wait on a single shared concurrent_queue
+class single_queue_pool
+{
+  public:
+    explicit single_queue_pool(size_t num_threads)
+    {
+      for(size_t i = 0; i < num_threads; ++i)
+      {
+        threads_.emplace_back([this]
+        {
+          agency::detail::unique_function<void()> task;
+
+          while(tasks_.wait_and_pop(task))
+          {
+            task();
+          }
+        });
+      }
+    }
+
+    ~single_queue_pool()
+    {
+      tasks_.close();
+
+      for(auto& t : threads_)
+      {
+        t.join();
+      }
+    }
+
+    template<class Function>
+    void submit(Function&& f)
+    {
+      tasks_.emplace(std::forward<Function>(f));
+    }
+
+  private:
+    agency::detail::concurrent_queue<agency::detail::unique_function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+};
+
+
+// submits num_tasks tasks to the given pool from num_producers threads
+// and returns the number of tasks executed per second
+template<class Pool>
+double measure_throughput(Pool& pool, size_t num_producers, size_t num_tasks)
+{
+  std::atomic<size_t> num_completed(0);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> producers;
+  for(size_t p = 0; p < num_producers; ++p)
+  {
+    producers.emplace_back([&,p]
+    {
+      size_t begin = p * num_tasks / num_producers;
+      size_t end = (p + 1) * num_tasks / num_producers;
+
+      for(size_t i = begin; i < end; ++i)
+      {
+        pool.submit([&]
+        {
+          num_completed.fetch_add(1, std::memory_order_relaxed);
+        });
+      }
+    });
+  }
+
+  for(auto& t : producers)
+  {
+    t.join();
+  }
+
+  while(num_completed.load(std::memory_order_relaxed) < num_tasks)
+  {
+    std::this_thread::yield();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+  return num_tasks / elapsed.count();
+}
+
+
+int main()
+{
+  const size_t num_tasks = 1 << 20;
+
+  size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<size_t> thread_counts;
+  for(size_t n = 1; n < max_threads; n *= 2)
+  {
+    thread_counts.push_back(n);
+  }
+  thread_counts.push_back(max_threads);
+
+  std::printf("%8s %24s %24s\n", "threads", "single queue (tasks/s)", "work stealing (tasks/s)");
+
+  for(size_t num_threads : thread_counts)
+  {
+    double single_queue_throughput = 0;
+    {
+      single_queue_pool pool(num_threads);
+      single_queue_throughput = measure_throughput(pool, num_threads, num_tasks);
+    }
+
+    double work_stealing_throughput = 0;
+    {
+      agency::detail::thread_pool pool(num_threads);
+      work_stealing_throughput = measure_throughput(pool, num_threads, num_tasks);
+    }
+
+    std::printf("%8zu %24.0f %24.0f\n", num_threads, single_queue_throughput, work_stealing_throughput);
+  }
+
+  return 0;
+}
+
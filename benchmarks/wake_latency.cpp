@@ -0,0 +1,143 @@
+// This program measures the wake-up latency of agency::detail's latches and semaphores, i.e. the time
+// from the moment one thread releases a waiting thread until the waiting thread resumes.
+//
+// It compares condition_variable_latch against atomic_wait_latch, which waits via atomic_wait(),
+// and a semaphore built from a mutex and condition variable against counting_semaphore.
+// Latches are released after the waiter has had time to park, while the semaphores are measured
+// by passing a token back and forth between two threads.
+
+#include <agency/detail/concurrency/latch.hpp>
+#include <agency/detail/concurrency/counting_semaphore.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using clock_type = std::chrono::high_resolution_clock;
+
+
+// returns the median latency in microseconds from count_down() to the return of a parked wait()
+template<class Latch>
+double measure_latch_latency(size_t num_samples)
+{
+  std::vector<double> latencies;
+
+  for(size_t i = 0; i < num_samples; ++i)
+  {
+    Latch latch(1);
+    clock_type::time_point release_time;
+    clock_type::time_point wake_time;
+
+    std::thread waiter([&]
+    {
+      latch.wait();
+      wake_time = clock_type::now();
+    });
+
+    // give the waiter time to park
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+    release_time = clock_type::now();
+    latch.count_down(1);
+
+    waiter.join();
+
+    std::chrono::duration<double, std::micro> latency = wake_time - release_time;
+    latencies.push_back(latency.count());
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  return latencies[latencies.size() / 2];
+}
+
+
+class condition_variable_semaphore
+{
+  public:
+    explicit condition_variable_semaphore(ptrdiff_t desired)
+      : count_(desired)
+    {}
+
+    void release()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++count_;
+      }
+
+      cv_.notify_one();
+    }
+
+    void acquire()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]{ return count_ > 0; });
+      --count_;
+    }
+
+  private:
+    ptrdiff_t count_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+
+// returns the average latency in microseconds of one hand-off of a token between two threads
+template<class Semaphore>
+double measure_semaphore_latency(size_t num_round_trips)
+{
+  Semaphore ping(0);
+  Semaphore pong(0);
+
+  auto start = clock_type::now();
+
+  std::thread partner([&]
+  {
+    for(size_t i = 0; i < num_round_trips; ++i)
+    {
+      ping.acquire();
+      pong.release();
+    }
+  });
+
+  for(size_t i = 0; i < num_round_trips; ++i)
+  {
+    ping.release();
+    pong.acquire();
+  }
+
+  partner.join();
+
+  std::chrono::duration<double, std::micro> elapsed = clock_type::now() - start;
+
+  return elapsed.count() / (2 * num_round_trips);
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  const size_t num_samples = 1000;
+  const size_t num_round_trips = 100000;
+
+  std::printf("%24s %24s %24s\n", "primitive", "cond. variable (us)", "atomic wait (us)");
+
+  std::printf("%24s %24.2f %24.2f\n", "latch (median)",
+    measure_latch_latency<condition_variable_latch>(num_samples),
+    measure_latch_latency<atomic_wait_latch>(num_samples)
+  );
+
+  std::printf("%24s %24.2f %24.2f\n", "semaphore (mean)",
+    measure_semaphore_latency<condition_variable_semaphore>(num_round_trips),
+    measure_semaphore_latency<counting_semaphore>(num_round_trips)
+  );
+
+  return 0;
+}
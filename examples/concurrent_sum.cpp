@@ -7,30 +7,16 @@ int sum(const std::vector<int>& data)
 
   return bulk_invoke(con(data.size()), [&](concurrent_agent& self) -> single_result<int>
   {
-    // copy data into scratch buffer
-    shared_vector<int> scratch(self, data);
-
-    auto i = self.index();
-    auto n = scratch.size();
-
-    while(n > 1)
+    // combine each agent's element with the rest of the group's
+    experimental::optional<int> result = self.reduce(data[self.index()], [](int x, int y)
     {
-      if(i < n/2)
-      {
-        scratch[i] += scratch[n - i - 1];
-      }
-
-      // wait for every agent in the group to reach this point
-      self.wait();
-
-      // cut the number of active agents in half
-      n -= n/2;
-    }
+      return x + y;
+    });
 
-    // the first agent returns the result
-    if(i == 0)
+    // the first agent receives and returns the result
+    if(result)
     {
-      return scratch[0];
+      return *result;
     }
 
     // all other agents return an ignored value 
@@ -0,0 +1,87 @@
+#include <agency/agency.hpp>
+#include <functional>
+#include <iostream>
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy, int num_agents)
+{
+  using agent = typename ExecutionPolicy::execution_agent_type;
+
+  {
+    // bulk_async with no parameters
+
+    auto f = agency::bulk_async(policy,
+      [](agent&) -> agency::reduce_result<int, std::plus<int>>
+    {
+      return 1;
+    });
+
+    auto result = f.get();
+
+    assert(result == num_agents);
+  }
+
+  {
+    // bulk_async with one parameter
+
+    int val = 13;
+
+    auto f = agency::bulk_async(policy,
+      [](agent&, int val) -> agency::reduce_result<int, std::plus<int>>
+    {
+      return val;
+    },
+    val);
+
+    auto result = f.get();
+
+    assert(result == 13 * num_agents);
+  }
+
+  {
+    // bulk_async with one shared parameter
+
+    int val = 13;
+
+    auto f = agency::bulk_async(policy,
+      [](agent& self, int& val) -> agency::reduce_result<int, std::plus<int>>
+    {
+      if(self.elect())
+      {
+        return val;
+      }
+
+      return std::ignore;
+    },
+    agency::share(val));
+
+    auto result = f.get();
+
+    assert(result == 13);
+  }
+}
+
+int main()
+{
+  using namespace agency;
+
+  test(seq(10), 10);
+  test(con(10), 10);
+  test(par(10), 10);
+
+  test(seq(10, seq(10)), 100);
+  test(seq(10, par(10)), 100);
+  test(seq(10, con(10)), 100);
+
+  test(con(10, seq(10)), 100);
+  test(con(10, par(10)), 100);
+  test(con(10, con(10)), 100);
+
+  test(par(10, seq(10)), 100);
+  test(par(10, con(10)), 100);
+  test(par(10, par(10)), 100);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
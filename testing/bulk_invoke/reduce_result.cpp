@@ -0,0 +1,111 @@
+#include <agency/agency.hpp>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <string>
+
+struct max_op
+{
+  int operator()(int a, int b) const
+  {
+    return a < b ? b : a;
+  }
+};
+
+template<class ExecutionPolicy>
+void test()
+{
+  using execution_policy_type = ExecutionPolicy;
+
+  {
+    // bulk_invoke with no parameters
+
+    execution_policy_type policy;
+
+    auto result = agency::bulk_invoke(policy(100),
+      [](typename execution_policy_type::execution_agent_type& self) -> agency::reduce_result<int, std::plus<int>>
+    {
+      return int(self.index());
+    });
+
+    assert(result == 4950);
+  }
+
+  {
+    // bulk_invoke with one parameter
+
+    execution_policy_type policy;
+
+    int val = 13;
+
+    auto result = agency::bulk_invoke(policy(10),
+      [](typename execution_policy_type::execution_agent_type& self, int val) -> agency::reduce_result<int, max_op>
+    {
+      return val + int(self.index());
+    },
+    val);
+
+    assert(result == 22);
+  }
+
+  {
+    // bulk_invoke with one shared parameter
+
+    execution_policy_type policy;
+
+    int val = 13;
+
+    auto result = agency::bulk_invoke(policy(10),
+      [](typename execution_policy_type::execution_agent_type&, int& val) -> agency::reduce_result<int, std::plus<int>>
+    {
+      return val;
+    },
+    agency::share(val));
+
+    assert(result == 130);
+  }
+
+  {
+    // agents which return std::ignore contribute nothing
+
+    execution_policy_type policy;
+
+    auto result = agency::bulk_invoke(policy(10),
+      [](typename execution_policy_type::execution_agent_type& self) -> agency::reduce_result<int, std::multiplies<int>>
+    {
+      if(self.index() % 2)
+      {
+        return 2;
+      }
+
+      return std::ignore;
+    });
+
+    assert(result == 32);
+  }
+
+  {
+    // when no agent contributes, the result is T()
+
+    execution_policy_type policy;
+
+    auto result = agency::bulk_invoke(policy(10),
+      [](typename execution_policy_type::execution_agent_type&) -> agency::reduce_result<std::string, std::plus<std::string>>
+    {
+      return std::ignore;
+    });
+
+    assert(result.empty());
+  }
+}
+
+int main()
+{
+  test<agency::sequenced_execution_policy>();
+  test<agency::concurrent_execution_policy>();
+  test<agency::parallel_execution_policy>();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <agency/agency.hpp>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+
+using histogram = std::array<int,8>;
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  using agent_type = typename ExecutionPolicy::execution_agent_type;
+
+  {
+    // count each agent into a bin of a histogram
+
+    size_t n = 100;
+
+    histogram zero{};
+    histogram result{};
+    size_t num_replicas = 0;
+
+    agency::bulk_invoke(policy(n), [](agent_type& self, histogram& local)
+    {
+      ++local[self.index() % local.size()];
+    },
+    agency::share_private(zero, [&](const histogram& replica) noexcept
+    {
+      // replicas are combined one at a time
+      ++num_replicas;
+      for(size_t i = 0; i < result.size(); ++i)
+      {
+        result[i] += replica[i];
+      }
+    }));
+
+    // each replica has been combined by the time bulk_invoke returns
+    assert(num_replicas > 0);
+    assert(std::accumulate(result.begin(), result.end(), 0) == int(n));
+
+    for(size_t i = 0; i < result.size(); ++i)
+    {
+      assert(result[i] == int((n + result.size() - 1 - i) / result.size()));
+    }
+  }
+
+  {
+    // replicas begin as copies of the initial value
+
+    size_t n = 10;
+
+    int sum = 0;
+
+    agency::bulk_invoke(policy(n), [](agent_type&, int& local)
+    {
+      local += 1;
+    },
+    agency::share_private(13, [&](int replica) noexcept
+    {
+      sum += replica - 13;
+    }));
+
+    assert(sum == int(n));
+  }
+
+  {
+    // replicas are combined before bulk_async's future becomes ready
+
+    size_t n = 100;
+
+    int sum = 0;
+
+    auto f = agency::bulk_async(policy(n), [](agent_type& self, int& local)
+    {
+      local += int(self.index());
+    },
+    agency::share_private(0, [&](int replica) noexcept
+    {
+      sum += replica;
+    }));
+
+    f.wait();
+
+    assert(sum == int(n * (n - 1) / 2));
+  }
+
+  {
+    // a share_private parameter may accompany an ordinary shared parameter
+
+    size_t n = 10;
+
+    int sum = 0;
+
+    agency::bulk_invoke(policy(n), [](agent_type&, int& local, const int& shared)
+    {
+      local += shared;
+    },
+    agency::share_private(0, [&](int replica) noexcept
+    {
+      sum += replica;
+    }),
+    agency::share(7));
+
+    assert(sum == int(7 * n));
+  }
+}
+
+int main()
+{
+  test(agency::seq);
+  test(agency::par);
+  test(agency::con);
+  test(agency::unseq);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include <agency/agency.hpp>
+#include <functional>
+
+template<class ExecutionPolicy>
+void test()
+{
+  using execution_policy_type = ExecutionPolicy;
+
+  {
+    // bulk_then with non-void future and no parameters
+
+    execution_policy_type policy;
+
+    auto fut = agency::make_ready_future<int>(policy.executor(), 7);
+
+    auto f = agency::bulk_then(policy(10),
+      [](typename execution_policy_type::execution_agent_type&, int& past_arg) -> agency::reduce_result<int, std::plus<int>>
+      {
+        return past_arg;
+      },
+      fut
+    );
+
+    auto result = f.get();
+
+    assert(result == 70);
+  }
+
+  {
+    // bulk_then with void future and no parameters
+
+    execution_policy_type policy;
+
+    auto fut = agency::make_ready_future<void>(policy.executor());
+
+    auto f = agency::bulk_then(policy(10),
+      [](typename execution_policy_type::execution_agent_type& self) -> agency::reduce_result<int, std::plus<int>>
+      {
+        return int(self.index());
+      },
+      fut
+    );
+
+    auto result = f.get();
+
+    assert(result == 45);
+  }
+
+  {
+    // bulk_then with non-void future and one shared parameter
+
+    execution_policy_type policy;
+
+    auto fut = agency::make_ready_future<int>(policy.executor(), 7);
+
+    auto f = agency::bulk_then(policy(10),
+      [](typename execution_policy_type::execution_agent_type& self, int& past_arg, int& val) -> agency::reduce_result<int, std::plus<int>>
+      {
+        if(self.index() == 0)
+        {
+          return past_arg + val;
+        }
+
+        return std::ignore;
+      },
+      fut,
+      agency::share(13)
+    );
+
+    auto result = f.get();
+
+    assert(result == 20);
+  }
+}
+
+int main()
+{
+  test<agency::sequenced_execution_policy>();
+  test<agency::concurrent_execution_policy>();
+  test<agency::parallel_execution_policy>();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <agency/detail/concurrency/atomic_wait.hpp>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+// a waiter waits for a to change from its initial value while a notifier changes it after a delay
+// with num_spins == 0 and num_yields == 0, the waiter parks immediately, so this exercises the parking path
+template<class T>
+void test_wait_and_notify(T initial, T changed, int num_spins, int num_yields)
+{
+  using namespace agency::detail;
+
+  std::atomic<T> a(initial);
+  std::atomic<bool> woken(false);
+
+  std::thread waiter([&]
+  {
+    atomic_wait(a, initial, num_spins, num_yields);
+    assert(a.load() == changed);
+    woken = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!woken);
+
+  a.store(changed);
+  atomic_notify_one(a);
+
+  waiter.join();
+  assert(woken);
+}
+
+
+// atomic_wait() returns immediately when the value already differs
+template<class T>
+void test_no_wait(T initial, T other)
+{
+  using namespace agency::detail;
+
+  std::atomic<T> a(initial);
+  atomic_wait(a, other, 0, 0);
+}
+
+
+// many waiters parked on the same object are all woken by atomic_notify_all()
+template<class T>
+void test_notify_all(T initial, T changed)
+{
+  using namespace agency::detail;
+
+  std::atomic<T> a(initial);
+  std::atomic<int> num_woken(0);
+
+  std::vector<std::thread> waiters;
+  for(int i = 0; i < 8; ++i)
+  {
+    waiters.emplace_back([&]
+    {
+      atomic_wait(a, initial, 0, 0);
+      ++num_woken;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(num_woken == 0);
+
+  a.store(changed);
+  atomic_notify_all(a);
+
+  for(auto& t : waiters) t.join();
+  assert(num_woken == 8);
+}
+
+
+// a woken waiter may destroy the object while the notifier is still notifying
+template<class T>
+void test_destroy_after_wake(T initial, T changed)
+{
+  using namespace agency::detail;
+
+  for(int i = 0; i < 100; ++i)
+  {
+    std::atomic<T>* a = new std::atomic<T>(initial);
+
+    std::thread waiter([=]
+    {
+      atomic_wait(*a, initial, 0, 0);
+      delete a;
+    });
+
+    a->store(changed);
+    atomic_notify_all(*a);
+
+    waiter.join();
+  }
+}
+
+
+// two threads take turns incrementing a counter, waking each other each time
+template<class T>
+void test_ping_pong()
+{
+  using namespace agency::detail;
+
+  const int num_turns = 1000;
+
+  std::atomic<T> turn(T(0));
+
+  std::thread other([&]
+  {
+    for(int i = 1; i < 2 * num_turns; i += 2)
+    {
+      atomic_wait(turn, T(i - 1));
+      assert(turn.load() == T(i));
+
+      turn.store(T(i + 1));
+      atomic_notify_one(turn);
+    }
+  });
+
+  for(int i = 0; i < 2 * num_turns; i += 2)
+  {
+    turn.store(T(i + 1));
+    atomic_notify_one(turn);
+
+    atomic_wait(turn, T(i + 1));
+    assert(turn.load() == T(i + 2));
+  }
+
+  other.join();
+}
+
+
+int main()
+{
+  // 4-byte objects park on a futex where available
+  test_wait_and_notify<int>(0, 1, 0, 0);
+  test_wait_and_notify<int>(0, 1, 16, 16);
+  test_wait_and_notify<int>(0, 1, agency::detail::default_atomic_wait_num_spins(), agency::detail::default_atomic_wait_num_yields);
+  test_no_wait<int>(0, 1);
+  test_notify_all<int>(0, 1);
+  test_destroy_after_wake<int>(0, 1);
+  test_ping_pong<int>();
+
+  // other objects park on a bucket's condition variable
+  test_wait_and_notify<std::uint64_t>(0, 1ull << 40, 0, 0);
+  test_wait_and_notify<std::uint64_t>(0, 1ull << 40, 16, 16);
+  test_no_wait<std::uint64_t>(0, 1);
+  test_notify_all<std::uint64_t>(0, 1ull << 40);
+  test_destroy_after_wake<std::uint64_t>(0, 1);
+  test_ping_pong<std::uint64_t>();
+
+  test_wait_and_notify<bool>(false, true, 0, 0);
+  test_no_wait<bool>(false, true);
+  test_notify_all<bool>(false, true);
+  test_destroy_after_wake<bool>(false, true);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <agency/detail/concurrency/barrier.hpp>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+// each participant publishes the number of the phase before it arrives at the barrier,
+// and after the barrier, checks that every other participant has published the same number
+//
+// if test_drop is true, one participant, which changes each phase, arrives via arrive_and_drop() rather than arrive_and_wait()
+// as it does not wait, it does not arrive again until some other participant reports that the phase has completed
+template<class Barrier>
+void test_barrier(size_t num_threads, int num_phases, bool test_drop)
+{
+  Barrier barrier(num_threads);
+  assert(barrier.count() == num_threads);
+
+  // double buffer the published phase numbers, so that participants which have moved on to
+  // the next phase do not overwrite the numbers which slower participants are still checking
+  std::vector<std::atomic<int>> published[2] = {std::vector<std::atomic<int>>(num_threads), std::vector<std::atomic<int>>(num_threads)};
+  for(auto& buffer : published)
+  {
+    for(auto& x : buffer) x = -1;
+  }
+
+  std::atomic<int> num_completed_phases(0);
+
+  std::vector<std::thread> threads;
+
+  for(size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&,i]
+    {
+      for(int phase = 0; phase < num_phases; ++phase)
+      {
+        std::vector<std::atomic<int>>& buffer = published[phase % 2];
+
+        buffer[i].store(phase, std::memory_order_relaxed);
+
+        if(test_drop && num_threads > 1 && i == phase % num_threads)
+        {
+          barrier.arrive_and_drop();
+
+          while(num_completed_phases.load() <= phase)
+          {
+            std::this_thread::yield();
+          }
+        }
+        else
+        {
+          barrier.arrive_and_wait();
+
+          for(auto& x : buffer)
+          {
+            assert(x.load(std::memory_order_relaxed) == phase);
+          }
+
+          if(num_completed_phases.load() <= phase)
+          {
+            num_completed_phases.store(phase + 1);
+          }
+        }
+      }
+    });
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  // counts which are not powers of tree_barrier's fan in leave partially filled nodes in the tree
+  size_t counts[] = {1, 2, 3, 5, 7, 16, 63, 64, 65, 130};
+
+  for(size_t n : counts)
+  {
+    int num_phases = n < 64 ? 200 : 50;
+
+    test_barrier<hybrid_barrier>(n, num_phases, false);
+    test_barrier<hybrid_barrier>(n, num_phases, true);
+
+    test_barrier<tree_barrier>(n, num_phases, false);
+    test_barrier<tree_barrier>(n, num_phases, true);
+
+    // barrier switches from hybrid_barrier to tree_barrier at 64 participants
+    test_barrier<barrier>(n, num_phases, false);
+    test_barrier<barrier>(n, num_phases, true);
+
+    test_barrier<blocking_barrier>(n, num_phases, true);
+  }
+
+  test_barrier<static_barrier<7>>(7, 200, false);
+  test_barrier<static_barrier<7>>(7, 200, true);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,261 @@
+#include <agency/detail/concurrency/concurrent_queue.hpp>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+void test_capacity()
+{
+  using namespace agency::detail;
+
+  bounded_concurrent_queue<int> queue(5);
+
+  // capacity is rounded up to a power of two
+  assert(queue.capacity() == 8);
+
+  // a queue with a single cell could not tell full from empty, so the capacity is at least two
+  bounded_concurrent_queue<int> small_queue(1);
+  assert(small_queue.capacity() == 2);
+  assert(small_queue.try_emplace(0));
+  assert(small_queue.try_emplace(1));
+  assert(!small_queue.try_emplace(2));
+}
+
+
+void test_full_and_empty()
+{
+  using namespace agency::detail;
+
+  bounded_concurrent_queue<int> queue(4);
+
+  int item = -1;
+  assert(!queue.try_pop(item));
+  assert(item == -1);
+
+  // wrap around the ring several times
+  for(int lap = 0; lap < 3; ++lap)
+  {
+    for(int i = 0; i < 4; ++i)
+    {
+      assert(queue.try_emplace(4 * lap + i));
+    }
+
+    assert(!queue.try_emplace(-1));
+
+    for(int i = 0; i < 4; ++i)
+    {
+      assert(queue.try_pop(item));
+      assert(item == 4 * lap + i);
+    }
+
+    assert(!queue.try_pop(item));
+  }
+}
+
+
+void test_destroys_unpopped_items()
+{
+  using namespace agency::detail;
+
+  std::shared_ptr<int> counter = std::make_shared<int>(0);
+
+  {
+    bounded_concurrent_queue<std::shared_ptr<int>> queue(4);
+
+    queue.try_emplace(counter);
+    queue.try_emplace(counter);
+
+    assert(counter.use_count() == 3);
+  }
+
+  assert(counter.use_count() == 1);
+}
+
+
+void test_blocking_producer()
+{
+  using namespace agency::detail;
+
+  bounded_concurrent_queue<int> queue(2);
+
+  assert(queue.push(0) == queue_status::open_and_ready);
+  assert(queue.push(1) == queue_status::open_and_ready);
+
+  // the queue is full, so this producer must block until the consumer below makes room
+  std::atomic<bool> pushed(false);
+  std::thread producer([&]
+  {
+    assert(queue.push(2) == queue_status::open_and_ready);
+    pushed = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  assert(!pushed);
+
+  int item = -1;
+  assert(queue.wait_and_pop(item));
+  assert(item == 0);
+
+  producer.join();
+  assert(pushed);
+
+  assert(queue.wait_and_pop(item));
+  assert(item == 1);
+  assert(queue.wait_and_pop(item));
+  assert(item == 2);
+}
+
+
+void test_blocking_consumer()
+{
+  using namespace agency::detail;
+
+  bounded_concurrent_queue<int> queue(2);
+
+  // the queue is empty, so this consumer must block until the producer below adds an item
+  std::atomic<bool> popped(false);
+  std::thread consumer([&]
+  {
+    int item = -1;
+    assert(queue.wait_and_pop(item));
+    assert(item == 13);
+    popped = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  assert(!popped);
+
+  assert(queue.push(13) == queue_status::open_and_ready);
+
+  consumer.join();
+  assert(popped);
+}
+
+
+void test_close()
+{
+  using namespace agency::detail;
+
+  {
+    // close() wakes a blocked consumer
+    bounded_concurrent_queue<int> queue(2);
+
+    std::thread consumer([&]
+    {
+      int item = -1;
+      assert(!queue.wait_and_pop(item));
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    queue.close();
+    consumer.join();
+
+    assert(queue.is_closed());
+    assert(queue.push(0) == queue_status::closed);
+  }
+
+  {
+    // close() wakes a blocked producer
+    bounded_concurrent_queue<int> queue(2);
+    assert(queue.push(0) == queue_status::open_and_ready);
+    assert(queue.push(1) == queue_status::open_and_ready);
+
+    std::thread producer([&]
+    {
+      assert(queue.push(2) == queue_status::closed);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    queue.close();
+    producer.join();
+  }
+}
+
+
+void test_multiple_producers_and_consumers()
+{
+  using namespace agency::detail;
+
+  const int num_producers = 4;
+  const int num_consumers = 4;
+  const int num_items_per_producer = 10000;
+  const int num_items = num_producers * num_items_per_producer;
+
+  // a small capacity keeps the queue alternating between full and empty
+  bounded_concurrent_queue<int> queue(8);
+
+  std::vector<std::atomic<int>> times_popped(num_items);
+  for(auto& t : times_popped) t = 0;
+
+  std::atomic<int> num_popped(0);
+
+  std::vector<std::thread> threads;
+
+  for(int p = 0; p < num_producers; ++p)
+  {
+    threads.emplace_back([&,p]
+    {
+      for(int i = 0; i < num_items_per_producer; ++i)
+      {
+        assert(queue.push(p * num_items_per_producer + i) == queue_status::open_and_ready);
+      }
+    });
+  }
+
+  for(int c = 0; c < num_consumers; ++c)
+  {
+    threads.emplace_back([&]
+    {
+      int item;
+      int previous_of_producer[num_producers];
+      for(int& prev : previous_of_producer) prev = -1;
+
+      while(queue.wait_and_pop(item))
+      {
+        // each consumer observes each producer's items in the order they were pushed
+        int producer = item / num_items_per_producer;
+        assert(item > previous_of_producer[producer]);
+        previous_of_producer[producer] = item;
+
+        ++times_popped[item];
+
+        if(++num_popped == num_items)
+        {
+          queue.close();
+        }
+      }
+    });
+  }
+
+  for(auto& t : threads)
+  {
+    t.join();
+  }
+
+  assert(num_popped == num_items);
+
+  for(auto& t : times_popped)
+  {
+    assert(t == 1);
+  }
+}
+
+
+int main()
+{
+  test_capacity();
+  test_full_and_empty();
+  test_destroys_unpopped_items();
+  test_blocking_producer();
+  test_blocking_consumer();
+  test_close();
+  test_multiple_producers_and_consumers();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include <agency/detail/concurrency/counting_semaphore.hpp>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+void test_try_acquire()
+{
+  using namespace agency::detail;
+
+  counting_semaphore semaphore(2);
+
+  assert(semaphore.try_acquire());
+  assert(semaphore.try_acquire());
+  assert(!semaphore.try_acquire());
+
+  semaphore.release();
+  assert(semaphore.try_acquire());
+  assert(!semaphore.try_acquire());
+
+  semaphore.release(2);
+  assert(semaphore.try_acquire());
+  assert(semaphore.try_acquire());
+  assert(!semaphore.try_acquire());
+}
+
+
+// acquire() blocks until release() makes a unit available
+void test_acquire_blocks()
+{
+  using namespace agency::detail;
+
+  counting_semaphore semaphore(0);
+  std::atomic<int> num_acquired(0);
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&]
+    {
+      semaphore.acquire();
+      ++num_acquired;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(num_acquired == 0);
+
+  // release() of a single unit wakes one acquirer
+  semaphore.release();
+  while(num_acquired < 1) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(num_acquired == 1);
+
+  // release() of several units wakes the rest
+  semaphore.release(3);
+  for(auto& t : threads) t.join();
+
+  assert(num_acquired == 4);
+  assert(!semaphore.try_acquire());
+}
+
+
+// the semaphore admits at most its initial count of threads into a critical section at once
+void test_mutual_exclusion(int count)
+{
+  using namespace agency::detail;
+
+  counting_semaphore semaphore(count);
+  std::atomic<int> num_inside(0);
+  std::atomic<int> max_inside(0);
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([&]
+    {
+      for(int j = 0; j < 1000; ++j)
+      {
+        semaphore.acquire();
+
+        int inside = ++num_inside;
+        assert(inside <= count);
+
+        int max = max_inside.load();
+        while(inside > max && !max_inside.compare_exchange_weak(max, inside)) {}
+
+        if(j % 100 == 0) std::this_thread::yield();
+
+        --num_inside;
+        semaphore.release();
+      }
+    });
+  }
+
+  for(auto& t : threads) t.join();
+
+  assert(max_inside <= count);
+
+  // every unit was returned
+  for(int i = 0; i < count; ++i)
+  {
+    assert(semaphore.try_acquire());
+  }
+  assert(!semaphore.try_acquire());
+}
+
+
+int main()
+{
+  test_try_acquire();
+  test_acquire_blocks();
+  test_mutual_exclusion(1);
+  test_mutual_exclusion(3);
+
+  bool threw = false;
+  try
+  {
+    agency::detail::counting_semaphore semaphore(-1);
+  }
+  catch(std::invalid_argument&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <agency/detail/concurrency/latch.hpp>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+// waiters block until the latch's count reaches zero, and observe every write which preceded a count_down()
+template<class Latch>
+void test_count_down_and_wait(int num_threads)
+{
+  Latch latch(num_threads);
+
+  std::vector<int> written(num_threads, 0);
+  std::vector<std::thread> threads;
+
+  for(int i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back([&,i]
+    {
+      written[i] = i + 1;
+
+      latch.count_down_and_wait();
+
+      for(int j = 0; j < num_threads; ++j)
+      {
+        assert(written[j] == j + 1);
+      }
+    });
+  }
+
+  for(auto& t : threads) t.join();
+
+  assert(latch.is_ready());
+}
+
+
+// wait() blocks until count_down() releases the latch
+template<class Latch>
+void test_wait()
+{
+  Latch latch(2);
+  std::atomic<int> num_woken(0);
+
+  std::vector<std::thread> waiters;
+  for(int i = 0; i < 4; ++i)
+  {
+    waiters.emplace_back([&]
+    {
+      latch.wait();
+      ++num_woken;
+    });
+  }
+
+  latch.count_down(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!latch.is_ready());
+  assert(num_woken == 0);
+
+  latch.count_down(1);
+  for(auto& t : waiters) t.join();
+
+  assert(num_woken == 4);
+
+  // waiting on a ready latch returns immediately
+  latch.wait();
+}
+
+
+// a single count_down() may release the latch by more than one
+template<class Latch>
+void test_count_down_many()
+{
+  Latch latch(5);
+
+  latch.count_down(3);
+  assert(!latch.is_ready());
+
+  latch.count_down(2);
+  assert(latch.is_ready());
+  latch.wait();
+}
+
+
+// a waiter may destroy the latch as soon as it is released, even while count_down() is still notifying
+template<class Latch>
+void test_destroy_after_wait()
+{
+  for(int i = 0; i < 100; ++i)
+  {
+    Latch* latch = new Latch(1);
+
+    std::thread waiter([=]
+    {
+      latch->wait();
+      delete latch;
+    });
+
+    latch->count_down(1);
+
+    waiter.join();
+  }
+}
+
+
+int main()
+{
+  using namespace agency::detail;
+
+  for(int n : {1, 2, 7, 32})
+  {
+    test_count_down_and_wait<atomic_wait_latch>(n);
+    test_count_down_and_wait<condition_variable_latch>(n);
+  }
+
+  test_wait<atomic_wait_latch>();
+  test_wait<condition_variable_latch>();
+
+  test_count_down_many<atomic_wait_latch>();
+  test_count_down_many<condition_variable_latch>();
+
+  test_destroy_after_wait<atomic_wait_latch>();
+
+  bool threw = false;
+  try
+  {
+    latch zero(0);
+  }
+  catch(std::invalid_argument&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+#include <agency/detail/unique_function.hpp>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+
+int& num_allocations()
+{
+  static int result = 0;
+  return result;
+}
+
+int& num_deallocations()
+{
+  static int result = 0;
+  return result;
+}
+
+
+// counting_allocator counts the allocations made through it and through its rebound copies
+template<class T>
+struct counting_allocator
+{
+  using value_type = T;
+
+  counting_allocator() = default;
+
+  template<class U>
+  counting_allocator(const counting_allocator<U>&) {}
+
+  template<class U, class... Args>
+  void construct(U* ptr, Args&&... args)
+  {
+    ::new(ptr) U(std::forward<Args>(args)...);
+  }
+
+  T* allocate(size_t n)
+  {
+    ++num_allocations();
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, size_t n)
+  {
+    ++num_deallocations();
+    std::allocator<T>().deallocate(ptr, n);
+  }
+};
+
+// destruction_counter counts the destructions of its objects which have not been moved from
+struct destruction_counter
+{
+  int* num_destructions;
+
+  destruction_counter(int* counter) : num_destructions(counter) {}
+
+  destruction_counter(destruction_counter&& other) noexcept
+    : num_destructions(other.num_destructions)
+  {
+    other.num_destructions = nullptr;
+  }
+
+  ~destruction_counter()
+  {
+    if(num_destructions) ++*num_destructions;
+  }
+};
+
+
+// small_function fits in unique_function's inline storage
+struct small_function
+{
+  destruction_counter counter;
+  int value;
+
+  small_function(int* num_destructions, int v) : counter(num_destructions), value(v) {}
+
+  int operator()(int x) const
+  {
+    return x + value;
+  }
+};
+
+// large_function is just too large for unique_function's inline storage
+struct large_function
+{
+  destruction_counter counter;
+  int value;
+  char padding[agency::detail::unique_function<int(int)>::inline_capacity + 1 - sizeof(destruction_counter) - sizeof(int)];
+
+  large_function(int* num_destructions, int v) : counter(num_destructions), value(v), padding() {}
+
+  int operator()(int x) const
+  {
+    return x + value;
+  }
+};
+
+static_assert(sizeof(small_function) <= agency::detail::unique_function<int(int)>::inline_capacity, "small_function should fit inline");
+static_assert(sizeof(large_function) > agency::detail::unique_function<int(int)>::inline_capacity, "large_function should not fit inline");
+
+
+template<class Function>
+void test_storage(bool expect_inline)
+{
+  using namespace agency::detail;
+
+  int num_destructions = 0;
+  int expected_allocations = num_allocations() + (expect_inline ? 0 : 1);
+
+  {
+    unique_function<int(int)> f(std::allocator_arg, counting_allocator<Function>(), Function{&num_destructions, 7});
+    assert(num_allocations() == expected_allocations);
+    assert(f);
+    assert(f(1) == 8);
+
+    // move construction leaves the source empty and does not allocate
+    unique_function<int(int)> g(std::move(f));
+    assert(!f);
+    assert(g);
+    assert(g(2) == 9);
+    assert(num_allocations() == expected_allocations);
+
+    // move assignment destroys the target's function
+    int num_other_destructions = 0;
+    unique_function<int(int)> h(std::allocator_arg, counting_allocator<Function>(), Function{&num_other_destructions, 13});
+    assert(h(0) == 13);
+    h = std::move(g);
+    assert(!g);
+    assert(h(3) == 10);
+    assert(num_other_destructions == 1);
+
+    // self move assignment does nothing
+    unique_function<int(int)>& h_ref = h;
+    h = std::move(h_ref);
+    assert(h(4) == 11);
+
+    // move assignment into an empty function
+    f = std::move(h);
+    assert(!h);
+    assert(f(5) == 12);
+
+    // none of the moves destroyed the function
+    assert(num_destructions == 0);
+  }
+
+  // the function was destroyed exactly once, and everything allocated was deallocated
+  assert(num_destructions == 1);
+  assert(num_allocations() == num_deallocations());
+}
+
+
+void test_moves_between_storage_modes()
+{
+  using namespace agency::detail;
+
+  int num_small_destructions = 0;
+  int num_large_destructions = 0;
+
+  {
+    unique_function<int(int)> small(std::allocator_arg, counting_allocator<small_function>(), small_function{&num_small_destructions, 1});
+    unique_function<int(int)> large(std::allocator_arg, counting_allocator<large_function>(), large_function{&num_large_destructions, 2});
+
+    // swap the two functions through a third
+    unique_function<int(int)> temp = std::move(small);
+    small = std::move(large);
+    large = std::move(temp);
+
+    assert(small(0) == 2);
+    assert(large(0) == 1);
+
+    // replace an allocated function with an inline one
+    small = std::move(large);
+    assert(num_large_destructions == 1);
+    assert(num_allocations() == num_deallocations());
+    assert(small(0) == 1);
+    assert(num_small_destructions == 0);
+  }
+
+  assert(num_small_destructions == 1);
+}
+
+
+void test_nullptr()
+{
+  using namespace agency::detail;
+
+  unique_function<int()> empty;
+  assert(!empty);
+
+  unique_function<int()> null(nullptr);
+  assert(!null);
+
+  bool threw = false;
+  try
+  {
+    null();
+  }
+  catch(bad_function_call&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  // assigning nullptr destroys the target
+  int num_destructions = 0;
+  unique_function<int(int)> f = small_function(&num_destructions, 0);
+  assert(f);
+  f = nullptr;
+  assert(!f);
+  assert(num_destructions == 1);
+
+  unique_function<int(int)> g(std::allocator_arg, counting_allocator<large_function>(), large_function{&num_destructions, 0});
+  g = nullptr;
+  assert(!g);
+  assert(num_destructions == 2);
+  assert(num_allocations() == num_deallocations());
+}
+
+
+void test_move_only_captures()
+{
+  using namespace agency::detail;
+
+  std::unique_ptr<int> ptr(new int(13));
+  int* raw = ptr.get();
+
+  // capture the unique_ptr via a move-only function object, as C++11 lambdas cannot move-capture
+  struct move_only_function
+  {
+    std::unique_ptr<int> ptr;
+
+    int* operator()() const
+    {
+      return ptr.get();
+    }
+  };
+
+  unique_function<int*()> f = move_only_function{std::move(ptr)};
+  assert(f() == raw);
+
+  unique_function<int*()> g = std::move(f);
+  assert(g() == raw);
+  assert(*g() == 13);
+}
+
+
+int main()
+{
+  test_storage<small_function>(true);
+  test_storage<large_function>(false);
+  test_moves_between_storage_modes();
+  test_nullptr();
+  test_move_only_captures();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <agency/agency.hpp>
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <string>
+
+
+struct plus
+{
+  template<class T>
+  T operator()(const T& a, const T& b) const
+  {
+    return a + b;
+  }
+};
+
+
+// this type is larger than a cache line and has a nontrivial destructor
+struct big
+{
+  std::string name;
+  double padding[16];
+
+  big operator+(const big& other) const
+  {
+    return big{name + other.name, {}};
+  }
+};
+
+
+template<class ExecutionPolicy>
+void test(ExecutionPolicy policy)
+{
+  using namespace agency;
+
+  size_t n = policy.param().domain().size();
+
+  {
+    // test reduce
+
+    auto result = bulk_invoke(policy, [](concurrent_agent& self) -> single_result<int>
+    {
+      auto sum = self.reduce(int(self.rank()) + 1, plus());
+
+      // only the first agent receives the result
+      assert(bool(sum) == (self.rank() == 0));
+
+      if(sum)
+      {
+        return *sum;
+      }
+
+      return std::ignore;
+    });
+
+    assert(result == int(n * (n + 1) / 2));
+  }
+
+  {
+    // test all_reduce, inclusive_scan, and exclusive_scan
+
+    auto results = bulk_invoke(policy, [](concurrent_agent& self)
+    {
+      int value = int(self.rank()) + 1;
+
+      int sum = self.all_reduce(value, plus());
+      int inclusive = self.inclusive_scan(value, plus());
+      int exclusive = self.exclusive_scan(value, 10, plus());
+
+      int rank = int(self.rank());
+      int group_size = int(self.group_size());
+
+      return sum == group_size * (group_size + 1) / 2 &&
+             inclusive == (rank + 1) * (rank + 2) / 2 &&
+             exclusive == 10 + rank * (rank + 1) / 2;
+    });
+
+    assert(std::vector<bool>(n, true) == std::vector<bool>(results.begin(), results.end()));
+  }
+
+  {
+    // test repeated broadcasts from different agents of small, nontrivially destructible, and large types
+
+    auto results = bulk_invoke(policy, [](concurrent_agent& self)
+    {
+      using namespace agency::experimental;
+
+      size_t n = self.group_size();
+      bool result = true;
+
+      for(size_t round = 0; round < 5; ++round)
+      {
+        size_t root = round % n;
+        bool is_root = self.rank() == root;
+
+        int i = self.broadcast(is_root ? make_optional(int(round)) : nullopt);
+        result = result && (i == int(round));
+
+        std::string str = self.broadcast(is_root ? make_optional(std::to_string(round)) : nullopt);
+        result = result && (str == std::to_string(round));
+
+        big b = self.broadcast(is_root ? make_optional(big{std::to_string(round), {}}) : nullopt);
+        result = result && (b.name == std::to_string(round));
+      }
+
+      return result;
+    });
+
+    assert(std::vector<bool>(n, true) == std::vector<bool>(results.begin(), results.end()));
+  }
+
+  {
+    // test a collective on a non-commutative operation over a large type
+
+    auto results = bulk_invoke(policy, [](concurrent_agent& self)
+    {
+      big value{std::string(1, char('a' + self.rank() % 26)), {}};
+
+      return self.inclusive_scan(value, plus()).name;
+    });
+
+    std::string expected;
+    for(size_t i = 0; i < n; ++i)
+    {
+      expected += char('a' + i % 26);
+      assert(results[i] == expected);
+    }
+  }
+}
+
+
+int main()
+{
+  using namespace agency;
+
+  test(con(1));
+  test(con(10));
+  test(con(100));
+
+  // test with scratch space large enough to hold every agent's slot
+  test(con(100).with_scratch(100 * sizeof(big) + 100 * 64));
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <agency/agency.hpp>
+#include <agency/experimental.hpp>
+#include <iostream>
+#include <cassert>
+#include <string>
+
+
+struct plus
+{
+  template<class T>
+  T operator()(const T& a, const T& b) const
+  {
+    return a + b;
+  }
+};
+
+
+// this type is larger than a cache line, so its collective slots cannot live in place
+struct big
+{
+  std::string name;
+  double padding[16];
+
+  big operator+(const big& other) const
+  {
+    return big{name + other.name, {}};
+  }
+};
+
+
+template<size_t group_size>
+void test()
+{
+  using namespace agency;
+  using agent_type = experimental::static_concurrent_agent<group_size>;
+
+  const size_t n = group_size;
+
+  auto results = bulk_invoke(experimental::static_concurrent_execution_policy<group_size>(), [=](agent_type& self)
+  {
+    assert(self.group_size() == n);
+
+    int rank = static_cast<int>(self.rank());
+
+    for(int iteration = 0; iteration < 10; ++iteration)
+    {
+      // test reduce
+      auto sum = self.reduce(rank + iteration, plus());
+      assert(bool(sum) == (rank == 0));
+      if(sum)
+      {
+        assert(*sum == int(n * (n - 1) / 2 + n * iteration));
+      }
+
+      // test all_reduce
+      assert(self.all_reduce(rank, plus()) == int(n * (n - 1) / 2));
+
+      // test consecutive scans of a type with a nontrivial destructor
+      std::string letter(1, char('a' + rank % 26));
+      std::string inclusive = self.inclusive_scan(letter, plus());
+      std::string exclusive = self.exclusive_scan(letter, std::string(), plus());
+      assert(inclusive.size() == self.rank() + 1);
+      assert(exclusive.size() == self.rank());
+      assert(inclusive == exclusive + letter);
+
+      // test a type too large for in-place slots
+      big value{letter, {}};
+      assert(self.all_reduce(value, plus()).name.size() == n);
+
+      // test broadcast
+      experimental::optional<int> message;
+      if(self.elect())
+      {
+        message = iteration;
+      }
+
+      assert(self.broadcast(message) == iteration);
+
+      self.wait();
+    }
+
+    return rank;
+  });
+
+  for(size_t i = 0; i < n; ++i)
+  {
+    assert(results[i] == int(i));
+  }
+}
+
+
+int main()
+{
+  test<1>();
+  test<2>();
+  test<8>();
+  test<16>();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,212 @@
+#include <agency/agency.hpp>
+#include <agency/memory/detail/resource/scratch_resource.hpp>
+#include <agency/memory/detail/resource/tiered_resource.hpp>
+#include <atomic>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+
+
+// counting_resource stands in for the heap beneath a group's scratch space and counts the allocations which reach it
+struct counting_resource
+{
+  static std::atomic<int> num_allocations;
+
+  void* allocate(std::size_t n)
+  {
+    ++num_allocations;
+    return std::malloc(n);
+  }
+
+  void deallocate(void* ptr, std::size_t)
+  {
+    std::free(ptr);
+  }
+
+  bool owns(void*, std::size_t) const
+  {
+    return true;
+  }
+
+  bool operator==(const counting_resource&) const
+  {
+    return true;
+  }
+
+  bool operator!=(const counting_resource&) const
+  {
+    return false;
+  }
+};
+
+std::atomic<int> counting_resource::num_allocations(0);
+
+
+using counting_agent = agency::detail::basic_concurrent_agent<
+  std::size_t,
+  agency::detail::default_barrier,
+  agency::detail::tiered_resource<agency::detail::scratch_resource, counting_resource>
+>;
+
+
+// counting_policy is like con, but its agents' memory resources fall back to a counting_resource
+class counting_policy : public agency::basic_execution_policy<counting_agent, agency::concurrent_executor, counting_policy>
+{
+  private:
+    using super_t = agency::basic_execution_policy<counting_agent, agency::concurrent_executor, counting_policy>;
+
+  public:
+    using super_t::basic_execution_policy;
+
+    counting_policy with_scratch(std::size_t num_bytes) const
+    {
+      param_type param = this->param();
+      param.set_scratch_size(num_bytes);
+      return counting_policy(param, this->executor());
+    }
+};
+
+
+// launches groups whose agents share a vector, and returns, for each launch, the vector's address
+// and the thread which launched the group
+//
+// the launching thread creates the group's shared parameters and executes the group's first agent
+std::vector<std::pair<float*,std::thread::id>> launch_shared_vectors(const counting_policy& policy, int num_launches)
+{
+  std::vector<std::pair<float*,std::thread::id>> launches;
+
+  for(int launch = 0; launch < num_launches; ++launch)
+  {
+    auto results = agency::bulk_invoke(policy, [=](counting_agent& self) -> agency::single_result<std::pair<float*,std::thread::id>>
+    {
+      agency::shared_vector<float> vec(self, 2048, 0.f);
+
+      vec[self.rank()] = float(launch);
+
+      self.wait();
+
+      assert(vec[(self.rank() + 1) % self.group_size()] == float(launch));
+
+      if(self.rank() == 0)
+      {
+        return std::make_pair(vec.data(), std::this_thread::get_id());
+      }
+
+      return std::ignore;
+    });
+
+    launches.push_back(results);
+  }
+
+  return launches;
+}
+
+
+void test_no_heap_allocation()
+{
+  const int num_launches = 20;
+
+  {
+    // without scratch space, each group's shared vector falls back to the heap
+    int num_allocations = counting_resource::num_allocations;
+
+    launch_shared_vectors(counting_policy()(10), num_launches);
+
+    assert(counting_resource::num_allocations - num_allocations >= num_launches);
+  }
+
+  {
+    // with enough scratch space, no group's shared vector reaches the heap
+    int num_allocations = counting_resource::num_allocations;
+
+    auto launches = launch_shared_vectors(counting_policy()(10).with_scratch(2048 * sizeof(float) + 1024), num_launches);
+
+    assert(counting_resource::num_allocations == num_allocations);
+
+    // and each launching thread recycles the same scratch space in every launch
+    std::map<std::thread::id, float*> address_of_thread;
+    for(auto& launch : launches)
+    {
+      auto found = address_of_thread.find(launch.second);
+      if(found == address_of_thread.end())
+      {
+        address_of_thread[launch.second] = launch.first;
+      }
+      else
+      {
+        assert(found->second == launch.first);
+      }
+    }
+  }
+}
+
+template<class ExecutionPolicy>
+void test(const ExecutionPolicy& policy)
+{
+  using namespace agency;
+
+  const std::size_t num_bytes = 1 << 16;
+
+  auto p = policy.with_scratch(num_bytes);
+
+  // with_scratch() should preserve the rest of the policy
+  assert(p.param().scratch_size() == num_bytes);
+  assert(p.param().domain().size() == policy.param().domain().size());
+  assert(p.executor() == policy.executor());
+
+  using agent_type = typename ExecutionPolicy::execution_agent_type;
+
+  for(int launch = 0; launch < 3; ++launch)
+  {
+    auto results = bulk_invoke(p, [=](agent_type& self)
+    {
+      // the elected agent allocates most of the scratch space and fills it
+      char* ptr = nullptr;
+      if(self.elect())
+      {
+        ptr = static_cast<char*>(self.memory_resource().allocate(num_bytes / 2));
+        std::memset(ptr, launch, num_bytes / 2);
+      }
+
+      ptr = self.broadcast(ptr ? experimental::optional<char*>(ptr) : experimental::nullopt);
+
+      bool result = ptr[self.rank()] == launch;
+
+      self.wait();
+
+      if(self.elect())
+      {
+        self.memory_resource().deallocate(ptr, num_bytes / 2);
+      }
+
+      return result;
+    });
+
+    for(bool result : results)
+    {
+      assert(result);
+    }
+  }
+}
+
+int main()
+{
+  using namespace agency;
+
+  // test a request for scratch space with no launch
+  assert(con.param().scratch_size() == 0);
+  assert(con2d.param().scratch_size() == 0);
+
+  test(con(10));
+  test(con2d({0,0}, {2,5}));
+
+  test_no_heap_allocation();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
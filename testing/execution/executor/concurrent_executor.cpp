@@ -2,11 +2,16 @@
 #include <type_traits>
 #include <vector>
 #include <cassert>
+#include <memory>
 
 #include <agency/execution/executor/concurrent_executor.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
+#include <agency/execution/executor/query.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/detail/concurrency/available_concurrency.hpp>
+#include <agency/detail/concurrency/barrier.hpp>
 
 int main()
 {
@@ -35,24 +40,105 @@ int main()
 
   concurrent_executor exec;
 
-  std::future<int> fut = agency::make_ready_future<int>(exec, 7);
+  {
+    // the concurrency available to the executor respects the process's affinity mask and CPU quota
 
-  size_t shape = 10;
-  
-  auto f = exec.bulk_then_execute(
-    [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+    assert(detail::parse_cgroup_cpu_max("400000 100000\n") == 4);
+    assert(detail::parse_cgroup_cpu_max("150000 100000") == 2);
+    assert(detail::parse_cgroup_cpu_max("max 100000") == 0);
+    assert(detail::cpu_quota_to_concurrency(-1, 100000) == 0);
+
+    size_t concurrency = agency::query(exec, agency::concurrency);
+
+    assert(concurrency >= 1);
+    assert(concurrency <= detail::affinity_cpus().size());
+    assert(concurrency == exec.unit_shape());
+  }
+
+  {
+    // bulk_then_execute() with non-void predecessor
+
+    std::future<int> fut = agency::make_ready_future<int>(exec, 7);
+
+    size_t shape = 10;
+    
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = past_arg + shared_arg[idx];
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+    
+    auto result = f.get();
+    
+    assert(std::vector<int>(10, 7 + 13) == result);
+  }
+
+  {
+    // bulk_then_execute() with void predecessor
+
+    std::future<void> fut = agency::make_ready_future<void>(exec);
+
+    size_t shape = 10;
+    
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx];
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+    
+    auto result = f.get();
+    
+    assert(std::vector<int>(10, 13) == result);
+  }
+
+  {
+    // repeated bulk_then_execute() whose agents require concurrent forward progress
+
+    size_t shape = 64;
+
+    for(int i = 0; i < 10; ++i)
     {
-      results[idx] = past_arg + shared_arg[idx];
-    },
-    shape,
-    fut,
-    [=]{ return std::vector<int>(shape); },     // results
-    [=]{ return std::vector<int>(shape, 13); }  // shared_arg
-  );
-  
-  auto result = f.get();
-  
-  assert(std::vector<int>(10, 7 + 13) == result);
+      std::future<void> fut = agency::make_ready_future<void>(exec);
+
+      auto f = exec.bulk_then_execute(
+        [=](size_t idx, std::vector<int>& results, std::shared_ptr<agency::detail::barrier>& barrier)
+        {
+          results[idx] = static_cast<int>(idx);
+
+          // every agent must arrive before any agent may proceed
+          barrier->arrive_and_wait();
+
+          int neighbor = results[(idx + 1) % shape];
+
+          // every agent must read its neighbor before any agent may write
+          barrier->arrive_and_wait();
+
+          results[idx] += neighbor;
+        },
+        shape,
+        fut,
+        [=]{ return std::vector<int>(shape); },              // results
+        [=]{ return std::make_shared<agency::detail::barrier>(shape); } // shared barrier
+      );
+
+      auto result = f.get();
+
+      for(size_t idx = 0; idx < shape; ++idx)
+      {
+        assert(result[idx] == static_cast<int>(idx + (idx + 1) % shape));
+      }
+    }
+  }
 
   std::cout << "OK" << std::endl;
 
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <stdexcept>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <agency/execution/executor/numa_executor.hpp>
+#include <agency/execution/executor/executor_traits.hpp>
+#include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
+#include <agency/execution/executor/customization_points.hpp>
+#include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/detail/concurrency/numa_topology.hpp>
+
+int main()
+{
+  using namespace agency;
+
+  static_assert(detail::is_bulk_then_executor<numa_executor>::value,
+    "numa_executor should be a bulk then executor");
+
+  static_assert(bulk_guarantee_t::static_query<numa_executor>() == bulk_guarantee_t::parallel_t(),
+    "numa_executor should have parallel static bulk guarantee");
+
+  static_assert(detail::is_detected_exact<size_t, executor_shape_t, numa_executor>::value,
+    "numa_executor should have size_t shape_type");
+
+  {
+    // parse_cpu_list() understands lists of ranges
+
+    assert(detail::parse_cpu_list("0-3,8,10-11\n") == std::vector<int>({0,1,2,3,8,10,11}));
+    assert(detail::parse_cpu_list("") == std::vector<int>());
+  }
+
+  {
+    // the topology always contains at least one node with processors
+
+    std::vector<detail::numa_node> topology = detail::numa_topology();
+
+    assert(!topology.empty());
+
+    for(auto& node : topology)
+    {
+      assert(!node.cpus.empty());
+    }
+
+    assert(numa_executor::num_nodes() == topology.size());
+
+    // numa_executors name nodes by the operating system's identifiers
+    std::vector<size_t> node_ids = numa_executor::node_ids();
+    assert(node_ids.size() == topology.size());
+
+    for(size_t i = 0; i < topology.size(); ++i)
+    {
+      assert(node_ids[i] == topology[i].id);
+    }
+
+    assert(numa_executor().node() == node_ids[0]);
+  }
+
+  {
+    // a node which is not available throws
+
+    std::vector<size_t> node_ids = numa_executor::node_ids();
+    size_t unavailable = *std::max_element(node_ids.begin(), node_ids.end()) + 1;
+
+    bool caught = false;
+    try
+    {
+      numa_executor exec(unavailable);
+    }
+    catch(std::out_of_range&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+  }
+
+  for(size_t node : numa_executor::node_ids())
+  {
+    // each node's executor executes all agents
+
+    numa_executor exec(node);
+
+    assert(exec.node() == node);
+    assert(exec == numa_executor(node));
+
+    std::future<int> fut = agency::make_ready_future<int>(exec, 7);
+
+    size_t shape = 100;
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& past_arg, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = past_arg + shared_arg[idx];
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    assert(std::vector<int>(shape, 7 + 13) == f.get());
+  }
+
+  {
+    // a thread_pool_executor bound to one node of a pool executes its agents only on that node's workers
+
+    std::vector<detail::numa_node> topology = detail::numa_topology();
+
+    // the nodes' identifiers need not match their positions
+    std::vector<detail::numa_node> two_nodes = {{2, topology[0].cpus}, {5, topology[0].cpus}};
+
+    // give each node two workers
+    two_nodes[0].cpus.resize(2, two_nodes[0].cpus[0]);
+    two_nodes[1].cpus.resize(2, two_nodes[1].cpus[0]);
+
+    detail::thread_pool pool(two_nodes);
+
+    assert(pool.size() == 4);
+    assert(pool.num_nodes() == 2);
+    assert(pool.node_size(1) == 2);
+    assert(pool.node_id(1) == 5);
+    assert(pool.find_node(5) == 1);
+    assert(pool.find_node(0) == pool.num_nodes());
+
+    // a node past the pool's last node throws
+    bool caught = false;
+    try
+    {
+      detail::thread_pool_executor bad_exec(pool, pool.num_nodes());
+    }
+    catch(std::out_of_range&)
+    {
+      caught = true;
+    }
+
+    assert(caught);
+
+    detail::thread_pool_executor exec(pool, 1);
+
+    assert(exec.unit_shape() == 2);
+    assert(exec != detail::thread_pool_executor(pool, 0));
+    assert(exec != detail::thread_pool_executor());
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    auto ready = agency::make_ready_future<void>(exec);
+
+    size_t shape = 1000;
+
+    auto f = exec.bulk_then_execute(
+      [&](size_t idx, std::vector<int>& results, int&)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          threads.insert(std::this_thread::get_id());
+        }
+
+        results[idx] = static_cast<int>(idx);
+      },
+      shape,
+      ready,
+      [=]{ return std::vector<int>(shape); }, // results
+      []{ return 0; }                         // shared_arg
+    );
+
+    auto result = f.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == static_cast<int>(i));
+    }
+
+    assert(threads.size() <= 2);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -7,6 +7,8 @@
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
 #include <agency/execution/executor/properties/bulk_guarantee.hpp>
+#include <agency/execution/executor/properties/concurrency.hpp>
+#include <agency/execution/executor/query.hpp>
 
 int main()
 {
@@ -24,14 +26,21 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, parallel_executor>::value,
     "parallel_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, parallel_executor, int>::value,
-    "parallel_executor should have std::future future");
+  static_assert(detail::is_detected_exact<detail::thread_pool_future<int>, executor_future_t, parallel_executor, int>::value,
+    "parallel_executor should have thread_pool_future future");
 
   static_assert(executor_execution_depth<parallel_executor>::value == 1,
     "parallel_executor should have execution_depth == 1");
 
+  // the default pool's size may be chosen before its first use, but not after
+  assert(set_default_thread_pool_size(3));
+
   parallel_executor exec;
 
+  assert(exec.unit_shape() == 3);
+  assert(agency::query(exec, agency::concurrency) == std::min<size_t>(3, detail::available_concurrency()));
+  assert(!set_default_thread_pool_size(5));
+
   std::future<int> fut = agency::make_ready_future<int>(exec, 7);
 
   size_t shape = 10;
@@ -51,6 +60,72 @@ int main()
   
   assert(std::vector<int>(10, 7 + 13) == result);
 
+  {
+    // parallel_executors bound to distinct pools are distinct and execute on their own pool
+
+    thread_pool pool(2);
+
+    parallel_executor pool_exec(pool);
+
+    assert(&pool_exec.pool() == &pool);
+    assert(&exec.pool() == &default_thread_pool());
+    assert(exec.unit_shape() == default_thread_pool().size());
+    assert(pool_exec.unit_shape() == 2);
+    assert(pool_exec == parallel_executor(pool));
+    assert(pool_exec != exec);
+
+    std::future<int> fut = agency::make_ready_future<int>(pool_exec, 7);
+
+    auto f = pool_exec.bulk_then_execute(
+      [&](size_t idx, int& past_arg, std::vector<int>& results, int&)
+      {
+        results[idx] = pool.is_worker_thread() ? past_arg : 0;
+      },
+      shape,
+      fut,
+      [=]{ return std::vector<int>(shape); }, // results
+      []{ return 0; }                         // shared_arg
+    );
+
+    assert(std::vector<int>(shape, 7) == f.get());
+  }
+
+  {
+    // pools whose idle workers spin or yield before parking execute work like any other pool
+
+    thread_pool::idle_policy spin(1 << 16, 64);
+
+    thread_pool pool(2, spin);
+
+    assert(pool.get_idle_policy().num_spins == spin.num_spins);
+    assert(pool.get_idle_policy().num_yields == spin.num_yields);
+
+    parallel_executor pool_exec(pool);
+
+    for(int i = 0; i < 2; ++i)
+    {
+      std::future<int> fut = agency::make_ready_future<int>(pool_exec, i);
+
+      auto f = pool_exec.bulk_then_execute(
+        [](size_t idx, int& past_arg, std::vector<int>& results, int&)
+        {
+          results[idx] = past_arg;
+        },
+        shape,
+        fut,
+        [=]{ return std::vector<int>(shape); }, // results
+        []{ return 0; }                         // shared_arg
+      );
+
+      assert(std::vector<int>(shape, i) == f.get());
+
+      // park immediately from now on
+      pool.set_idle_policy(thread_pool::idle_policy());
+    }
+
+    assert(pool.get_idle_policy().num_spins == 0);
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
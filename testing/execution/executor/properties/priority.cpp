@@ -0,0 +1,88 @@
+#include <agency/execution/executor.hpp>
+#include <agency/execution/executor/properties/priority.hpp>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+int main()
+{
+  using namespace agency;
+
+  {
+    // test query() and require()
+
+    parallel_executor exec;
+
+    assert(agency::query(exec, priority) == priority_t::normal);
+
+    auto urgent = agency::require(exec, priority(priority_t::high));
+
+    assert(agency::query(urgent, priority) == priority_t::high);
+    assert(urgent != exec);
+    assert(agency::require(urgent, priority(priority_t::normal)) == exec);
+  }
+
+  {
+    // test that work of high priority skips past queued work of lower priority
+
+    thread_pool pool(1);
+
+    parallel_executor exec(pool);
+
+    // occupy the pool's only thread until all of the work below has been queued
+    std::atomic<bool> go(false);
+    auto ready = agency::make_ready_future<void>(exec);
+    auto occupied = exec.bulk_then_execute(
+      [&](size_t, int&, int&)
+      {
+        while(!go) std::this_thread::yield();
+      },
+      1,
+      ready,
+      []{ return 0; }, // result
+      []{ return 0; }  // shared_arg
+    );
+
+    std::mutex mutex;
+    std::vector<priority_t::level_type> order;
+
+    auto launch = [&](priority_t::level_type level)
+    {
+      auto ready = agency::make_ready_future<void>(exec);
+
+      return agency::require(exec, priority(level)).bulk_then_execute(
+        [&,level](size_t, int&, int&)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          order.push_back(level);
+        },
+        1,
+        ready,
+        []{ return 0; }, // result
+        []{ return 0; }  // shared_arg
+      );
+    };
+
+    auto low = launch(priority_t::low);
+    auto normal = launch(priority_t::normal);
+    auto high = launch(priority_t::high);
+
+    go = true;
+
+    occupied.wait();
+
+    low.wait();
+    normal.wait();
+    high.wait();
+
+    assert(order == std::vector<priority_t::level_type>({priority_t::high, priority_t::normal, priority_t::low}));
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
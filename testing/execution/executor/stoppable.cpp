@@ -0,0 +1,127 @@
+#include <agency/agency.hpp>
+#include <agency/execution/executor/properties/stoppable.hpp>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+
+template<class Executor>
+void test(Executor exec)
+{
+  {
+    // a stop requested before the launch executes no agents
+
+    agency::stop_source stop;
+    stop.request_stop();
+
+    auto stoppable_exec = agency::require(exec, agency::stoppable(stop.get_token()));
+
+    std::atomic<int> num_executed(0);
+
+    agency::bulk_invoke(agency::par(100).on(stoppable_exec), [&](agency::parallel_agent&)
+    {
+      ++num_executed;
+    });
+
+    assert(num_executed == 0);
+  }
+
+  {
+    // agents which begin after a stop is requested are skipped
+
+    size_t n = 1 << 16;
+
+    agency::stop_source stop;
+
+    auto stoppable_exec = agency::require(exec, agency::stoppable(stop.get_token()));
+
+    std::atomic<int> num_executed(0);
+
+    auto result = agency::bulk_invoke(agency::par(n).on(stoppable_exec), [&](agency::parallel_agent& self)
+    {
+      ++num_executed;
+
+      if(self.index() == 3)
+      {
+        stop.request_stop();
+      }
+
+      return 1;
+    });
+
+    assert(stop.stop_requested());
+    assert(num_executed > 0);
+    assert(num_executed < int(n));
+
+    // the results of skipped agents remain default-constructed
+    int num_results = 0;
+    for(auto x : result)
+    {
+      num_results += x;
+    }
+
+    assert(num_results == num_executed);
+  }
+
+  {
+    // bulk_async's future becomes ready early
+
+    size_t n = 1 << 16;
+
+    agency::stop_source stop;
+
+    auto stoppable_exec = agency::require(exec, agency::stoppable(stop.get_token()));
+
+    std::atomic<int> num_executed(0);
+
+    auto f = agency::bulk_async(agency::par(n).on(stoppable_exec), [=,&num_executed](agency::parallel_agent& self)
+    {
+      ++num_executed;
+
+      if(self.index() == 0)
+      {
+        stop.request_stop();
+      }
+    });
+
+    f.wait();
+
+    assert(num_executed < int(n));
+  }
+
+  {
+    // without a stop request, every agent executes
+
+    agency::stop_source stop;
+
+    auto stoppable_exec = agency::require(exec, agency::stoppable(stop.get_token()));
+
+    std::atomic<int> num_executed(0);
+
+    agency::bulk_invoke(agency::par(100).on(stoppable_exec), [&](agency::parallel_agent&)
+    {
+      ++num_executed;
+    });
+
+    assert(num_executed == 100);
+  }
+}
+
+int main()
+{
+  test(agency::sequenced_executor());
+  test(agency::parallel_executor());
+
+  {
+    // stoppable executors report their token
+    agency::stop_source stop;
+
+    auto exec = agency::require(agency::parallel_executor(), agency::stoppable(stop.get_token()));
+
+    assert(agency::query(exec, agency::stoppable) == stop.get_token());
+    assert(exec != agency::parallel_executor());
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -1,9 +1,14 @@
 #include <iostream>
 #include <type_traits>
 #include <vector>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <numeric>
 
-// XXX use parallel_executor.hpp instead of thread_pool.hpp due to circular #inclusion problems
-#include <agency/execution/executor/parallel_executor.hpp>
+#include <agency/execution/executor/detail/thread_pool_executor.hpp>
+#include <agency/detail/concurrency/latch.hpp>
 #include <agency/execution/executor/executor_traits.hpp>
 #include <agency/execution/executor/executor_traits/detail/is_bulk_then_executor.hpp>
 #include <agency/execution/executor/customization_points.hpp>
@@ -26,8 +31,8 @@ int main()
   static_assert(detail::is_detected_exact<size_t, executor_index_t, detail::thread_pool_executor>::value,
     "thread_pool_executor should have size_t index_type");
 
-  static_assert(detail::is_detected_exact<std::future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
-    "thread_pool_executor should have std::future future");
+  static_assert(detail::is_detected_exact<detail::thread_pool_future<int>, executor_future_t, detail::thread_pool_executor, int>::value,
+    "thread_pool_executor should have thread_pool_future future");
 
   static_assert(executor_execution_depth<detail::thread_pool_executor>::value == 1,
     "thread_pool_executor should have execution_depth == 1");
@@ -38,7 +43,7 @@ int main()
   {
     // bulk_then_execute() with non-void predecessor
     
-    std::future<int> predecessor_fut = agency::make_ready_future<int>(exec, 7);
+    executor_future_t<detail::thread_pool_executor,int> predecessor_fut = agency::make_ready_future<int>(exec, 7);
 
     size_t shape = 10;
     
@@ -62,7 +67,7 @@ int main()
   {
     // bulk_then_execute() with void predecessor
     
-    std::future<void> predecessor_fut = agency::make_ready_future<void>(exec);
+    executor_future_t<detail::thread_pool_executor,void> predecessor_fut = agency::make_ready_future<void>(exec);
 
     size_t shape = 10;
     
@@ -82,6 +87,326 @@ int main()
     assert(std::vector<int>(10, 13) == result);
   }
 
+  {
+    // bulk_then_execute() with many more agents than threads
+
+    std::future<void> predecessor_fut = agency::make_ready_future<void>(exec);
+
+    size_t shape = 10000;
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = shared_arg[idx] + static_cast<int>(idx);
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    auto result = f.get();
+
+    std::vector<int> expected(shape);
+    for(size_t i = 0; i < shape; ++i)
+    {
+      expected[i] = 13 + static_cast<int>(i);
+    }
+
+    assert(expected == result);
+  }
+
+  {
+    // bulk_then_execute() with no agents
+
+    std::future<int> predecessor_fut = agency::make_ready_future<int>(exec, 7);
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& predecessor, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = predecessor + shared_arg[idx];
+      },
+      0,
+      predecessor_fut,
+      []{ return std::vector<int>(); },    // results
+      []{ return std::vector<int>(); }     // shared_arg
+    );
+
+    auto result = f.get();
+
+    assert(result.empty());
+  }
+
+  {
+    // bulk_then_execute() with std::future predecessor which is not yet ready
+
+    std::promise<int> promise;
+    std::future<int> predecessor_fut = promise.get_future();
+
+    size_t shape = 10;
+
+    auto f = exec.bulk_then_execute(
+      [](size_t idx, int& predecessor, std::vector<int>& results, std::vector<int>& shared_arg)
+      {
+        results[idx] = predecessor + shared_arg[idx];
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); },     // results
+      [=]{ return std::vector<int>(shape, 13); }  // shared_arg
+    );
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(!f.is_ready());
+
+    promise.set_value(7);
+
+    auto result = f.get();
+
+    assert(std::vector<int>(10, 7 + 13) == result);
+  }
+
+  {
+    // chain bulk_then_execute() launches without waiting in between
+
+    auto f = agency::make_ready_future<int>(exec, 0);
+
+    for(int i = 0; i < 100; ++i)
+    {
+      f = exec.bulk_then_execute(
+        [](size_t idx, int& predecessor, int& result, std::vector<int>& shared_arg)
+        {
+          shared_arg[idx] = predecessor + 1;
+
+          if(idx == 0) result = shared_arg[idx];
+        },
+        4,
+        f,
+        []{ return 0; },                       // result
+        []{ return std::vector<int>(4); }      // shared_arg
+      );
+    }
+
+    assert(f.get() == 100);
+  }
+
+  {
+    // a predecessor's exception propagates through bulk_then_execute()
+
+    auto predecessor_fut = agency::make_ready_future<int>(exec, 7).then([](int&) -> int
+    {
+      throw 13;
+    });
+
+    auto f = exec.bulk_then_execute(
+      [](size_t, int&, int&, int&) {},
+      10,
+      predecessor_fut,
+      []{ return 0; }, // result
+      []{ return 0; }  // shared_arg
+    );
+
+    bool caught = false;
+
+    try
+    {
+      f.get();
+    }
+    catch(int e)
+    {
+      caught = (e == 13);
+    }
+
+    assert(caught);
+  }
+
+  {
+    // nested bulk_then_execute() launched and waited on by the pool's own threads
+
+    size_t shape = 16;
+
+    auto predecessor_fut = agency::make_ready_future<void>(exec);
+
+    auto f = exec.bulk_then_execute(
+      [=](size_t idx, std::vector<int>& results, int&)
+      {
+        auto ready = agency::make_ready_future<void>(detail::thread_pool_executor());
+
+        auto inner = detail::thread_pool_executor().bulk_then_execute(
+          [](size_t inner_idx, int& inner_result, int&)
+          {
+            if(inner_idx == 0) inner_result = 1;
+          },
+          shape,
+          ready,
+          []{ return 0; }, // inner_result
+          []{ return 0; }  // inner shared_arg
+        );
+
+        results[idx] = inner.get() + static_cast<int>(idx);
+      },
+      shape,
+      predecessor_fut,
+      [=]{ return std::vector<int>(shape); }, // results
+      []{ return 0; }                         // shared_arg
+    );
+
+    auto result = f.get();
+
+    for(size_t i = 0; i < shape; ++i)
+    {
+      assert(result[i] == 1 + static_cast<int>(i));
+    }
+  }
+
+  {
+    // tasks submitted from outside a pool begin in the order of their submission
+
+    detail::thread_pool pool(1);
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+
+    // occupy the pool's only thread while the other tasks are submitted
+    pool.submit([=]
+    {
+      opened.wait();
+    });
+
+    std::vector<int> order;
+    std::vector<std::future<void>> done;
+
+    for(int i = 0; i < 8; ++i)
+    {
+      done.push_back(pool.async([&order,i]
+      {
+        order.push_back(i);
+      }));
+    }
+
+    gate.set_value();
+
+    for(auto& f : done)
+    {
+      f.wait();
+    }
+
+    std::vector<int> expected(8);
+    std::iota(expected.begin(), expected.end(), 0);
+
+    assert(order == expected);
+  }
+
+  {
+    // a worker which waits with nothing to help with parks rather than occupying its processor
+
+    detail::thread_pool pool(1);
+    detail::latch latch(1);
+
+    std::clock_t start = std::clock();
+
+    std::future<void> waited = pool.async([&]
+    {
+      latch.wait();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    latch.count_down(1);
+    waited.wait();
+
+    double cpu_seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+    assert(cpu_seconds < 0.1);
+  }
+
+  {
+    // sleeping workers wake for each newly submitted task
+
+    detail::thread_pool pool(4);
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      if(i % 100 == 0)
+      {
+        // give every worker time to go to sleep
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+
+      assert(pool.async([=]{ return i; }).get() == i);
+    }
+
+    // wake all the workers at once
+    std::vector<std::future<int>> results;
+    for(int i = 0; i < 100; ++i)
+    {
+      results.push_back(pool.async([=]{ return i; }));
+    }
+
+    for(int i = 0; i < 100; ++i)
+    {
+      assert(results[i].get() == i);
+    }
+  }
+
+  {
+    // a pool whose workers are going to sleep, or are asleep, stops promptly
+
+    for(int i = 0; i < 100; ++i)
+    {
+      detail::thread_pool pool(4);
+
+      if(i % 10 == 0)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  {
+    // the continuations of a future created through an executor execute on that executor's pool,
+    // even when the future is made ready by a thread outside of the pool
+
+    detail::thread_pool pool(2);
+    detail::thread_pool_executor pool_exec(pool);
+
+    auto on_pool = [&](int& x)
+    {
+      return pool.is_worker_thread() ? x + 1 : -1;
+    };
+
+    auto f = agency::make_ready_future<int>(pool_exec, 7).then(on_pool).then(on_pool);
+    assert(f.get() == 9);
+
+    // the same goes for the result of a launch whose predecessor is a foreign future
+    std::promise<int> promise;
+    std::future<int> predecessor_fut = promise.get_future();
+
+    auto g = pool_exec.bulk_then_execute(
+      [](size_t, int& predecessor, int& result, int&)
+      {
+        result = predecessor;
+      },
+      1,
+      predecessor_fut,
+      []{ return 0; }, // result
+      []{ return 0; }  // shared_arg
+    ).then(on_pool);
+
+    promise.set_value(13);
+    assert(g.get() == 14);
+  }
+
+  {
+    // thread_pool_future converts to std::future
+
+    std::future<int> f = agency::make_ready_future<int>(exec, 7).then([](int& x)
+    {
+      return x + 13;
+    });
+
+    assert(f.get() == 7 + 13);
+  }
+
   std::cout << "OK" << std::endl;
 
   return 0;
@@ -0,0 +1,153 @@
+#include <cassert>
+#include <agency/future.hpp>
+#include <agency/detail/concurrency/elastic_thread_pool.hpp>
+#include <agency/detail/concurrency/thread_pool.hpp>
+#include <future>
+#include <iostream>
+
+int main()
+{
+  using namespace agency;
+
+  // give the system thread pool a single thread, so that a continuation occupying it would deadlock below
+  assert(detail::set_system_thread_pool_size(1));
+
+  {
+    // a continuation may block on the system thread pool's work
+    std::future<int> f0 = detail::make_ready_future<int>(13);
+
+    std::future<int> f1 = detail::monadic_then(f0, [](int& x)
+    {
+      return detail::system_thread_pool().async([=]
+      {
+        return x + 7;
+      }).get();
+    });
+
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // ready std::future<int>
+    std::future<int> f0 = detail::make_ready_future<int>(13);
+
+    std::future<int> f1 = detail::monadic_then(f0, [](int& x)
+    {
+      return x + 7;
+    });
+
+    assert(!f0.valid());
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // std::future<void> which is not yet ready
+    std::promise<void> p;
+    std::future<void> f0 = p.get_future();
+
+    bool executed = false;
+
+    std::future<void> f1 = detail::monadic_then(f0, [&]
+    {
+      executed = true;
+    });
+
+    p.set_value();
+    f1.get();
+
+    assert(executed);
+  }
+
+  {
+    // std::shared_future<int>
+    std::shared_future<int> f0 = detail::make_ready_future<int>(13).share();
+
+    std::future<int> f1 = detail::monadic_then(f0, [](int& x)
+    {
+      return x + 7;
+    });
+
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // deferred policy
+    std::future<int> f0 = detail::make_ready_future<int>(13);
+
+    std::future<int> f1 = detail::monadic_then(f0, std::launch::deferred, [](int& x)
+    {
+      return x + 7;
+    });
+
+    assert(f1.wait_for(std::chrono::seconds(0)) == std::future_status::deferred);
+    assert(f1.get() == 13 + 7);
+  }
+
+  {
+    // exceptions propagate to the result
+    std::future<int> f0 = detail::make_ready_future<int>(13);
+
+    std::future<int> f1 = detail::monadic_then(f0, [](int&) -> int
+    {
+      throw 7;
+    });
+
+    bool caught = false;
+
+    try
+    {
+      f1.get();
+    }
+    catch(int e)
+    {
+      caught = (e == 7);
+    }
+
+    assert(caught);
+  }
+
+  {
+    // a long chain of continuations
+    std::future<int> f = detail::make_ready_future<int>(0);
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      f = detail::monadic_then(f, [](int& x)
+      {
+        return x + 1;
+      });
+    }
+
+    assert(f.get() == 1000);
+  }
+
+  {
+    // a long chain of continuations which are pending does not occupy a thread for each continuation
+    size_t num_threads_before = detail::system_elastic_thread_pool().size();
+
+    std::promise<int> p;
+    std::future<int> f = p.get_future();
+
+    for(int i = 0; i < 200; ++i)
+    {
+      f = detail::monadic_then(f, [](int& x)
+      {
+        return x + 1;
+      });
+    }
+
+    assert(detail::system_elastic_thread_pool().size() == num_threads_before);
+
+    p.set_value(0);
+
+    assert(f.get() == 200);
+
+    // the continuations execute one after another, so the pool reuses its threads rather than growing for each
+    assert(detail::system_elastic_thread_pool().size() <= num_threads_before + 4);
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
+
@@ -0,0 +1,127 @@
+#include <agency/memory/detail/resource/cached_resource.hpp>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+
+// tracking_resource records the size of each of its live allocations
+struct tracking_resource
+{
+  static std::map<void*,size_t> live_blocks;
+
+  void* allocate(size_t num_bytes)
+  {
+    void* result = std::malloc(num_bytes);
+    live_blocks[result] = num_bytes;
+    return result;
+  }
+
+  void deallocate(void* ptr, size_t num_bytes)
+  {
+    // the size of a deallocation must match the size of its allocation
+    assert(live_blocks.count(ptr) && live_blocks[ptr] == num_bytes);
+    live_blocks.erase(ptr);
+    std::free(ptr);
+  }
+};
+
+std::map<void*,size_t> tracking_resource::live_blocks;
+
+
+void test_reuse()
+{
+  agency::detail::cached_resource<tracking_resource> resource;
+
+  {
+    // a free block is reused by a request of slightly different size
+
+    void* ptr = resource.allocate(1000);
+    resource.deallocate(ptr, 1000);
+    assert(resource.cached_bytes() >= 1000);
+
+    void* reused = resource.allocate(1010);
+    assert(reused == ptr);
+    assert(resource.cached_bytes() == 0);
+    resource.deallocate(reused, 1010);
+
+    reused = resource.allocate(900);
+    assert(reused == ptr);
+    resource.deallocate(reused, 900);
+  }
+
+  {
+    // a large free block is not wasted on a small request
+
+    void* large = resource.allocate(1 << 20);
+    resource.deallocate(large, 1 << 20);
+
+    void* small = resource.allocate(100);
+    assert(small != large);
+    resource.deallocate(small, 100);
+  }
+
+  {
+    // requests of varying size do not grow the base resource's blocks without bound
+
+    size_t num_blocks = tracking_resource::live_blocks.size();
+
+    for(size_t n = 1800; n <= 2048; ++n)
+    {
+      void* ptr = resource.allocate(n);
+      resource.deallocate(ptr, n);
+    }
+
+    assert(tracking_resource::live_blocks.size() <= num_blocks + 1);
+  }
+
+  resource.trim();
+  assert(resource.cached_bytes() == 0);
+  assert(tracking_resource::live_blocks.empty());
+}
+
+
+void test_max_cached_bytes()
+{
+  agency::detail::cached_resource<tracking_resource> resource;
+
+  resource.max_cached_bytes(4096);
+  assert(resource.max_cached_bytes() == 4096);
+
+  void* blocks[16];
+  for(int i = 0; i < 16; ++i)
+  {
+    blocks[i] = resource.allocate(1024);
+  }
+
+  for(int i = 0; i < 16; ++i)
+  {
+    resource.deallocate(blocks[i], 1024);
+    assert(resource.cached_bytes() <= 4096);
+  }
+
+  assert(tracking_resource::live_blocks.size() == 4);
+
+  // lowering the limit releases free blocks
+  resource.max_cached_bytes(1024);
+  assert(resource.cached_bytes() <= 1024);
+  assert(tracking_resource::live_blocks.size() == 1);
+
+  // trim() retains up to the given number of bytes
+  resource.trim(1024);
+  assert(tracking_resource::live_blocks.size() == 1);
+
+  resource.trim();
+  assert(tracking_resource::live_blocks.empty());
+}
+
+
+int main()
+{
+  test_reuse();
+  test_max_cached_bytes();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,349 @@
+#include <agency/agency.hpp>
+#include <agency/memory/detail/resource/cached_resource.hpp>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+
+// counting_resource counts the allocations made through it
+struct counting_resource
+{
+  static std::atomic<int> num_allocations;
+  static std::atomic<int> num_deallocations;
+
+  void* allocate(size_t num_bytes)
+  {
+    ++num_allocations;
+    return std::malloc(num_bytes);
+  }
+
+  void deallocate(void* ptr, size_t)
+  {
+    ++num_deallocations;
+    std::free(ptr);
+  }
+};
+
+std::atomic<int> counting_resource::num_allocations(0);
+std::atomic<int> counting_resource::num_deallocations(0);
+
+bool operator==(const counting_resource&, const counting_resource&)
+{
+  return true;
+}
+
+bool operator!=(const counting_resource&, const counting_resource&)
+{
+  return false;
+}
+
+bool operator<(const counting_resource&, const counting_resource&)
+{
+  return false;
+}
+
+
+void test_reuse()
+{
+  using namespace agency::detail;
+
+  globally_cached_resource<counting_resource> resource;
+
+  {
+    // a deallocated block is reused by the next allocation of its size class
+
+    void* ptr = resource.allocate(100);
+    std::memset(ptr, 0, 100);
+    resource.deallocate(ptr, 100);
+
+    int num_allocations = counting_resource::num_allocations;
+
+    // 100 and 128 bytes share a size class
+    void* reused = resource.allocate(128);
+    assert(reused == ptr);
+    assert(counting_resource::num_allocations == num_allocations);
+
+    resource.deallocate(reused, 128);
+  }
+
+  {
+    // blocks larger than the largest size class are cached as well
+
+    size_t large = size_t(1) << 22;
+
+    void* ptr = resource.allocate(large);
+    std::memset(ptr, 0, large);
+    resource.deallocate(ptr, large);
+
+    int num_allocations = counting_resource::num_allocations;
+
+    void* reused = resource.allocate(large);
+    assert(reused == ptr);
+    assert(counting_resource::num_allocations == num_allocations);
+
+    resource.deallocate(reused, large);
+  }
+
+  {
+    // many live blocks of many sizes
+
+    std::vector<std::pair<char*,size_t>> blocks;
+
+    for(size_t i = 0; i < 1000; ++i)
+    {
+      size_t n = 1 + (i * 37) % 5000;
+      char* ptr = reinterpret_cast<char*>(resource.allocate(n));
+      std::memset(ptr, int(i), n);
+      blocks.emplace_back(ptr, n);
+    }
+
+    for(size_t i = 0; i < blocks.size(); ++i)
+    {
+      assert(blocks[i].first[0] == char(i));
+      assert(blocks[i].first[blocks[i].second - 1] == char(i));
+      resource.deallocate(blocks[i].first, blocks[i].second);
+    }
+  }
+}
+
+
+void test_bins()
+{
+  using namespace agency::detail;
+
+  using shared_resource_type = size_class_cached_resource<counting_resource>;
+  using thread_cache_type = size_class_thread_cache<counting_resource>;
+
+  // bins of small classes hold many blocks, while bins of large classes are limited by their total size
+  assert(thread_cache_type::bin_capacity(shared_resource_type::size_class(64)) == 32);
+  assert(thread_cache_type::bin_capacity(shared_resource_type::size_class(size_t(1) << 16)) == 4);
+  assert(thread_cache_type::bin_capacity(shared_resource_type::size_class(shared_resource_type::max_size_class_size)) == 0);
+
+  for(size_t c = 0; c < shared_resource_type::num_size_classes; ++c)
+  {
+    assert(thread_cache_type::bin_capacity(c) * shared_resource_type::size_of_class(c) <= 256 * 1024);
+  }
+
+  globally_cached_resource<counting_resource> resource;
+
+  {
+    // a miss creates a single block rather than a batch of new blocks
+    size_t n = (size_t(1) << 15) + 1;
+
+    int num_allocations = counting_resource::num_allocations;
+
+    void* ptr = resource.allocate(n);
+    assert(counting_resource::num_allocations == num_allocations + 1);
+
+    void* other = resource.allocate(n);
+    assert(counting_resource::num_allocations == num_allocations + 2);
+
+    resource.deallocate(ptr, n);
+    resource.deallocate(other, n);
+
+    // both blocks are reused
+    num_allocations = counting_resource::num_allocations;
+
+    ptr = resource.allocate(n);
+    other = resource.allocate(n);
+    assert(counting_resource::num_allocations == num_allocations);
+
+    resource.deallocate(ptr, n);
+    resource.deallocate(other, n);
+  }
+
+  {
+    // blocks of classes which threads do not cache are still reused through the shared tier
+    size_t n = shared_resource_type::max_size_class_size;
+
+    void* ptr = resource.allocate(n);
+    resource.deallocate(ptr, n);
+
+    int num_allocations = counting_resource::num_allocations;
+
+    std::thread other([&]
+    {
+      void* reused = resource.allocate(n);
+      assert(reused == ptr);
+      resource.deallocate(reused, n);
+    });
+    other.join();
+
+    assert(counting_resource::num_allocations == num_allocations);
+  }
+}
+
+
+void test_trim()
+{
+  using namespace agency::detail;
+
+  globally_cached_resource<counting_resource> resource;
+
+  // cache blocks of many sizes, both small and large
+  std::vector<std::pair<void*,size_t>> blocks;
+  for(size_t n = 16; n <= (size_t(1) << 22); n *= 2)
+  {
+    blocks.emplace_back(resource.allocate(n), n);
+  }
+
+  for(auto& b : blocks)
+  {
+    resource.deallocate(b.first, b.second);
+  }
+
+  assert(resource.cached_bytes() > 0);
+
+  // trim() returns everything cached by this thread and by the shared tier to the base resource
+  resource.trim();
+  assert(resource.cached_bytes() == 0);
+  assert(counting_resource::num_allocations == counting_resource::num_deallocations);
+
+  {
+    // another thread's cache returns its blocks once the thread notices the trim
+
+    std::atomic<int> step(0);
+
+    std::thread other([&]
+    {
+      void* ptr = resource.allocate(64);
+      resource.deallocate(ptr, 64);
+      step = 1;
+
+      while(step != 2) std::this_thread::yield();
+
+      // this allocation follows the trim below, so it first returns this thread's cached block to the shared tier
+      ptr = resource.allocate(32);
+      step = 3;
+
+      while(step != 4) std::this_thread::yield();
+
+      // the thread's cache returns this block to the shared tier when the thread exits
+      resource.deallocate(ptr, 32);
+    });
+
+    while(step != 1) std::this_thread::yield();
+
+    // the other thread still caches its block
+    resource.trim();
+    assert(counting_resource::num_allocations > counting_resource::num_deallocations);
+    int num_deallocations = counting_resource::num_deallocations;
+
+    step = 2;
+    while(step != 3) std::this_thread::yield();
+
+    resource.trim();
+    assert(counting_resource::num_deallocations == num_deallocations + 1);
+
+    step = 4;
+    other.join();
+
+    resource.trim();
+    assert(counting_resource::num_allocations == counting_resource::num_deallocations);
+  }
+
+  {
+    // max_cached_bytes() limits the bytes retained by the shared tier and by each thread's cache
+
+    const size_t max_bytes = size_t(1) << 16;
+    const size_t n = 4096;
+
+    assert(resource.max_cached_bytes() == std::numeric_limits<size_t>::max());
+    resource.max_cached_bytes(max_bytes);
+    assert(resource.max_cached_bytes() == max_bytes);
+
+    std::vector<void*> small_blocks(100);
+    for(auto& ptr : small_blocks)
+    {
+      ptr = resource.allocate(n);
+    }
+
+    for(auto ptr : small_blocks)
+    {
+      resource.deallocate(ptr, n);
+    }
+
+    int num_retained = counting_resource::num_allocations - counting_resource::num_deallocations;
+    assert(num_retained > 0);
+    assert(num_retained * n <= 2 * max_bytes);
+
+    // large blocks are limited as well
+    size_t large = size_t(1) << 21;
+    resource.deallocate(resource.allocate(large), large);
+    assert(counting_resource::num_allocations - counting_resource::num_deallocations == num_retained);
+
+    resource.max_cached_bytes(std::numeric_limits<size_t>::max());
+    resource.trim();
+    assert(counting_resource::num_allocations == counting_resource::num_deallocations);
+  }
+}
+
+
+void test_threads()
+{
+  using namespace agency::detail;
+
+  {
+    // blocks may be deallocated by a thread other than the one which allocated them
+
+    globally_cached_resource<counting_resource> resource;
+
+    std::vector<void*> blocks(1000);
+
+    std::thread producer([&]
+    {
+      for(auto& ptr : blocks)
+      {
+        ptr = resource.allocate(64);
+        std::memset(ptr, 0, 64);
+      }
+    });
+    producer.join();
+
+    std::thread consumer([&]
+    {
+      for(auto ptr : blocks)
+      {
+        resource.deallocate(ptr, 64);
+      }
+    });
+    consumer.join();
+  }
+
+  {
+    // agents allocate and deallocate concurrently
+
+    agency::bulk_invoke(agency::par(64), [](agency::parallel_agent& self)
+    {
+      globally_cached_resource<counting_resource> resource;
+
+      for(int i = 0; i < 1000; ++i)
+      {
+        size_t n = 8 << (i % 10);
+
+        int* ptr = reinterpret_cast<int*>(resource.allocate(n));
+        *ptr = int(self.index());
+        assert(*ptr == int(self.index()));
+        resource.deallocate(ptr, n);
+      }
+    });
+  }
+}
+
+
+int main()
+{
+  test_reuse();
+  test_bins();
+  test_trim();
+  test_threads();
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}